@@ -0,0 +1,110 @@
+/**
+ *  @file   generate.cpp
+ *  @brief  Synthetic logs for the benchmarks
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "generate.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "../src/days.h"
+#include "../src/logger.h"
+
+// the newest generated entry, fixed so runs are comparable
+const char *newestID = "31122025";
+
+string generateText(size_t size, unsigned int &seed) {
+  const char *vocabulary[] = {"the",    "coffee",  "Thesis",      "draft",
+                              "notes",  "Lunch",   "with",        "50%",
+                              "review", "and",     "a",           "long",
+                              "walk",   "EVENING", "<b>bold</b>", "&",
+                              "paper",  "meeting", "train",       " indented"};
+  const size_t nWords = sizeof(vocabulary) / sizeof(vocabulary[0]);
+
+  string text;
+  text.reserve(size + 128);
+  while (text.length() < size) {
+    if (!text.empty())
+      text += "\r\n";
+    for (size_t column = 0; column < 72 && text.length() < size;) {
+      seed = seed * 1103515245 + 12345;
+      const char *word = vocabulary[(seed >> 16) % nWords];
+      text += word;
+      text += ' ';
+      column += strlen(word) + 1;
+    }
+  }
+
+  return (text);
+}
+
+// daily entries of about size bytes, newest first like the log keeps them
+bool generateLog(const string &file, int years, size_t size) {
+  ofstream ofstr(file.c_str(), ios::out | ios::binary | ios::trunc);
+  unsigned int seed = 42;
+  uint32_t newest = dayKey(newestID);
+
+  ofstr << entries << '\n';
+  for (uint32_t day = 0; day < static_cast<uint32_t>(years) * 365; day++) {
+    string ID = dayID(newest - day);
+    ofstr << "  " << entryID << ID << " >\n"
+          << "    " << contentID << ID << " >\n"
+          << generateText(size, seed) << '\n'
+          << endContent << "\n\n";
+  }
+  ofstr << endEntries << '\n';
+
+  return (!ofstr.fail());
+}
+
+string encodeURL(const string &text) {
+  string encoded;
+  for (size_t i = 0; i < text.length(); i++) {
+    unsigned char c = text[i];
+    if (c == ' ')
+      encoded += '+';
+    else if (isalnum(c))
+      encoded += c;
+    else {
+      char hex[4];
+      snprintf(hex, sizeof(hex), "%%%02X", c);
+      encoded += hex;
+    }
+  }
+  return (encoded);
+}
+
+// the $log of a generated log in the given storage, a directory when it
+// is sharded
+string storageLog(const string &storage) {
+  if (storage == "segment")
+    return ("log.seg");
+  if (storage == "sharded")
+    return ("log");
+
+  return ("log.dat");
+}
+
+// the work directory of a benchmark and everything in it
+void removeDirectory(const string &directory) {
+  DIR *dir = opendir(directory.c_str());
+  if (dir == NULL)
+    return;
+
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL)
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0 &&
+        unlink((directory + "/" + entry->d_name).c_str()) != 0)
+      removeDirectory(directory + "/" + entry->d_name);
+  closedir(dir);
+  rmdir(directory.c_str());
+}
@@ -0,0 +1,25 @@
+/**
+ *  @file   generate.h
+ *  @brief  Synthetic logs for the benchmarks
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef GENERATE_H_
+#define GENERATE_H_
+
+#include <string>
+
+using namespace std;
+
+extern const char *newestID;
+
+string generateText(size_t size, unsigned int &seed);
+bool generateLog(const string &file, int years, size_t size);
+string encodeURL(const string &text);
+string storageLog(const string &storage);
+void removeDirectory(const string &directory);
+
+#endif // GENERATE_H_
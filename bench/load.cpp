@@ -0,0 +1,703 @@
+/**
+ *  @file   load.cpp
+ *  @brief  End-to-end load driver for index.cgi
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/config.h"
+#include "../src/fastcgi.h"
+#include "../src/store.h"
+#include "generate.h"
+
+using namespace std;
+
+typedef enum { TODAY, VIEW, PAGE, SEARCH, SAVE, ACTIONS } LOAD_ACTION;
+
+static const char *actionNames[ACTIONS] = {"today", "view", "page", "search",
+                                           "save"};
+
+typedef struct {
+  int action;
+  string method;
+  string query;
+  string body;
+  string ID;
+  string content;
+} LOAD_REQUEST;
+
+typedef struct {
+  int action;
+  double seconds;
+  bool ok;
+} LOAD_SAMPLE;
+
+static string cgi, socketPath;
+static int port = 0, writers = 0;
+static vector<string> IDs;
+static int weights[ACTIONS] = {1, 5, 1, 2, 1};
+static size_t entrySize = 1000;
+
+static atomic<long> remaining;
+static mutex samplesLock;
+static vector<LOAD_SAMPLE> samples;
+static map<string, set<string>> posted;
+
+static LOAD_REQUEST makeRequest(unsigned int &seed, int worker, long sequence) {
+  int total = 0, pick;
+  for (int action = 0; action < ACTIONS; action++)
+    total += weights[action];
+  seed = seed * 1103515245 + 12345;
+  pick = (seed >> 8) % total;
+
+  LOAD_REQUEST request;
+  for (request.action = 0; pick >= weights[request.action]; request.action++)
+    pick -= weights[request.action];
+  if (worker < writers)
+    request.action = SAVE;
+  request.method = "GET";
+
+  seed = seed * 1103515245 + 12345;
+  const string &ID = IDs[(seed >> 8) % IDs.size()];
+  const char *matches[] = {"coffee", "thesis+draft", "zzzz", "walk"};
+
+  switch (request.action) {
+  case TODAY:
+    request.query = "action=today";
+    break;
+  case VIEW:
+    request.query = "action=view&ID=" + ID;
+    break;
+  case PAGE:
+    request.query = "action=view&limit=20";
+    break;
+  case SEARCH:
+    request.query = "action=search&ID=000000&match=" +
+                    string(matches[(seed >> 4) % 4]);
+    break;
+  default:
+    // every save is unique, so the log shows which one won
+    request.method = "POST";
+    request.query = "action=save&ID=" + ID;
+    request.ID = ID;
+    request.content = "saved by worker " + to_string(worker) + " as " +
+                      to_string(sequence) + "\r\n" +
+                      generateText(entrySize, seed);
+    request.body = "content=" + encodeURL(request.content);
+  }
+
+  return (request);
+}
+
+static bool writeAll(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return (false);
+    data += written;
+    length -= written;
+  }
+  return (true);
+}
+
+static bool readAll(int fd, char *data, size_t length) {
+  while (length > 0) {
+    ssize_t got = read(fd, data, length);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return (false);
+    data += got;
+    length -= got;
+  }
+  return (true);
+}
+
+// one process per request with the environment a web server would set
+static bool runCGI(const LOAD_REQUEST &request, string &output) {
+  int in[2], out[2];
+  if (pipe2(in, O_CLOEXEC) != 0)
+    return (false);
+  if (pipe2(out, O_CLOEXEC) != 0) {
+    close(in[0]);
+    close(in[1]);
+    return (false);
+  }
+
+  string environment[] = {"GATEWAY_INTERFACE=CGI/1.1",
+                          "SERVER_PROTOCOL=HTTP/1.1",
+                          "SCRIPT_NAME=/index.cgi",
+                          "REQUEST_METHOD=" + request.method,
+                          "QUERY_STRING=" + request.query,
+                          "CONTENT_LENGTH=" + to_string(request.body.length())};
+  char *envp[7], *argv[] = {const_cast<char *>(cgi.c_str()), NULL};
+  for (int i = 0; i < 6; i++)
+    envp[i] = const_cast<char *>(environment[i].c_str());
+  envp[6] = NULL;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+
+  pid_t pid;
+  int spawned = posix_spawn(&pid, cgi.c_str(), &actions, NULL, argv, envp);
+  posix_spawn_file_actions_destroy(&actions);
+  close(in[0]);
+  close(out[1]);
+  if (spawned != 0) {
+    close(in[1]);
+    close(out[0]);
+    return (false);
+  }
+
+  bool sent = writeAll(in[1], request.body.data(), request.body.length());
+  close(in[1]);
+
+  char buffer[65536];
+  ssize_t got;
+  while ((got = read(out[0], buffer, sizeof(buffer))) != 0) {
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got < 0)
+      break;
+    output.append(buffer, got);
+  }
+  close(out[0]);
+
+  int status;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    ;
+
+  return (sent && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void record(string &out, int type, const string &content) {
+  for (size_t at = 0; at < content.length() || at == 0; at += 65535) {
+    size_t length = min(content.length() - at, static_cast<size_t>(65535));
+    unsigned char header[8] = {FCGI_VERSION_1,
+                               static_cast<unsigned char>(type),
+                               0,
+                               1,
+                               static_cast<unsigned char>(length >> 8),
+                               static_cast<unsigned char>(length & 0xff),
+                               0,
+                               0};
+    out.append(reinterpret_cast<char *>(header), 8);
+    out.append(content, at, length);
+    if (content.empty())
+      break;
+  }
+}
+
+static void param(string &out, const string &name, const string &value) {
+  const string *parts[] = {&name, &value};
+  for (int i = 0; i < 2; i++) {
+    size_t length = parts[i]->length();
+    if (length < 128)
+      out += static_cast<char>(length);
+    else {
+      out += static_cast<char>((length >> 24) | 0x80);
+      out += static_cast<char>(length >> 16);
+      out += static_cast<char>(length >> 8);
+      out += static_cast<char>(length);
+    }
+  }
+  out += name + value;
+}
+
+// one connection per request, the way web servers talk to a responder
+static bool runFastCGI(const LOAD_REQUEST &request, string &output) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+  if (fd < 0 ||
+      connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+              sizeof(address)) != 0) {
+    if (fd >= 0)
+      close(fd);
+    return (false);
+  }
+
+  string params, out;
+  param(params, "GATEWAY_INTERFACE", "CGI/1.1");
+  param(params, "SERVER_PROTOCOL", "HTTP/1.1");
+  param(params, "SCRIPT_NAME", "/index.cgi");
+  param(params, "REQUEST_METHOD", request.method);
+  param(params, "QUERY_STRING", request.query);
+  param(params, "CONTENT_LENGTH", to_string(request.body.length()));
+
+  const char begin[8] = {0, FCGI_RESPONDER, 0, 0, 0, 0, 0, 0};
+  record(out, FCGI_BEGIN_REQUEST, string(begin, 8));
+  record(out, FCGI_PARAMS, params);
+  record(out, FCGI_PARAMS, "");
+  if (!request.body.empty())
+    record(out, FCGI_STDIN, request.body);
+  record(out, FCGI_STDIN, "");
+
+  bool ok = writeAll(fd, out.data(), out.length()), ended = false;
+  unsigned char header[8];
+  string content;
+  while (ok && !ended && readAll(fd, reinterpret_cast<char *>(header), 8)) {
+    size_t length = header[4] << 8 | header[5];
+    content.resize(length + header[6]);
+    if (!readAll(fd, &content[0], content.length()))
+      break;
+    if (header[1] == FCGI_STDOUT)
+      output.append(content, 0, length);
+    else if (header[1] == FCGI_END_REQUEST)
+      ended = length >= 5 && content[4] == FCGI_REQUEST_COMPLETE;
+  }
+  close(fd);
+
+  return (ok && ended);
+}
+
+// Every client keeps its connection to the built-in server open. The
+// response is handed back the way a CGI would have written it.
+static bool runHTTP(const LOAD_REQUEST &request, string &output, int &fd) {
+  if (fd < 0) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int on = 1;
+    if (fd < 0 ||
+        connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+                sizeof(address)) != 0 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) != 0) {
+      if (fd >= 0)
+        close(fd);
+      fd = -1;
+      return (false);
+    }
+  }
+
+  string out = request.method + " /index.cgi?" + request.query +
+               " HTTP/1.1\r\nHost: localhost\r\nContent-Length: " +
+               to_string(request.body.length()) + "\r\n\r\n" + request.body;
+  if (!writeAll(fd, out.data(), out.length())) {
+    close(fd);
+    fd = -1;
+    return (false);
+  }
+
+  string in;
+  char buffer[65536];
+  size_t end = string::npos, length = 0;
+  while (end == string::npos || in.length() < end + 4 + length) {
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0) {
+      close(fd);
+      fd = -1;
+      return (false);
+    }
+    in.append(buffer, got);
+
+    if (end == string::npos && (end = in.find("\r\n\r\n")) != string::npos) {
+      size_t at = in.find("\r\nContent-Length: ");
+      if (at < end)
+        length = strtoul(in.c_str() + at + 18, NULL, 10);
+    }
+  }
+
+  string head = in.substr(0, end + 2), status = head.substr(9, 3);
+  if (status != "200")
+    output = "Status: " + status + "\n";
+  for (size_t at = head.find("\r\n") + 2; at < head.length();) {
+    size_t eol = head.find("\r\n", at);
+    output += head.substr(at, eol - at) + "\n";
+    at = eol + 2;
+  }
+  output += "\n" + in.substr(end + 4, length);
+
+  return (true);
+}
+
+static void worker(int number) {
+  unsigned int seed = 12345 + number;
+  long sequence;
+  vector<LOAD_SAMPLE> mine;
+  int connection = -1;
+  while ((sequence = remaining--) > 0) {
+    LOAD_REQUEST request = makeRequest(seed, number, sequence);
+    string output;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool ok = port > 0              ? runHTTP(request, output, connection)
+              : socketPath.empty() ? runCGI(request, output)
+                                   : runFastCGI(request, output);
+    LOAD_SAMPLE sample = {
+        request.action,
+        chrono::duration<double>(chrono::steady_clock::now() - start).count(),
+        ok};
+
+    // an error page or a Status line is a failed request as well
+    string head = "\n" + output.substr(0, output.find("\n\n") + 1);
+    sample.ok = ok && head.find("\nContent-type:") != string::npos &&
+                head.find("\nStatus:") == string::npos &&
+                output.find("An error occured!") == string::npos &&
+                output.find("</html>") != string::npos;
+    mine.push_back(sample);
+
+    // the store keeps the line break before the end of content marker
+    if (request.action == SAVE) {
+      lock_guard<mutex> guard(samplesLock);
+      posted[request.ID].insert(request.content + '\n');
+    }
+  }
+
+  if (connection >= 0)
+    close(connection);
+
+  lock_guard<mutex> guard(samplesLock);
+  samples.insert(samples.end(), mine.begin(), mine.end());
+}
+
+static ERROR_CODE readEntries(map<string, string> &entries, long &count) {
+  CONFIG config;
+  ERROR_CODE state = configRead("bol.cfg", config);
+  if (state == OK)
+    state = storeOpen(config.log, config.storage);
+  if (state != OK)
+    return (state);
+
+  vector<long> positions;
+  state = storeAll(positions);
+  count = positions.size();
+
+  string_view content;
+  for (size_t i = 0; i < positions.size() && state == OK; i++)
+    if ((state = storeRead(positions[i], content)) == OK)
+      entries[storeID(positions[i])] = string(content);
+
+  return (state);
+}
+
+static double percentile(const vector<double> &sorted, double fraction) {
+  if (sorted.empty())
+    return (0);
+  size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+  return (sorted[min(sorted.size(), max(rank, static_cast<size_t>(1))) - 1]);
+}
+
+static bool parseMix(const string &mix) {
+  int parsed[ACTIONS] = {0, 0, 0, 0, 0};
+  istringstream istrstr(mix);
+  string part;
+  while (getline(istrstr, part, ',')) {
+    size_t equals = part.find('=');
+    int action = 0;
+    while (action < ACTIONS && part.substr(0, equals) != actionNames[action])
+      action++;
+    if (equals == string::npos || action == ACTIONS)
+      return (false);
+    parsed[action] = atoi(part.substr(equals + 1).c_str());
+  }
+
+  int total = 0;
+  for (int action = 0; action < ACTIONS; action++)
+    total += (weights[action] = max(parsed[action], 0));
+  return (total > 0);
+}
+
+static int usage(const char *program) {
+  cerr << "usage: " << program
+       << " [--cgi ./index.cgi] [--fastcgi | --socket path | --serve]"
+       << endl
+       << "       [--dir directory] [--concurrency 8] [--writers 0]"
+       << " [--requests 2000]"
+       << " [--mix today=1,view=5,page=1,search=2,save=1]" << endl
+       << "       [--years 5] [--size 1000] [--storage text|segment|sharded]"
+       << endl;
+  return (2);
+}
+
+int main(int argc, char *argv[]) {
+  string directory, storage = "text";
+  int concurrency = 8, years = 5;
+  long requests = 2000;
+  bool fastcgi = false, serve = false;
+
+  for (int i = 1; i < argc; i++) {
+    string option = argv[i];
+    if (option == "--fastcgi" || option == "--serve") {
+      (option == "--fastcgi" ? fastcgi : serve) = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+      return (usage(argv[0]));
+    string value = argv[++i];
+    if (option == "--cgi")
+      cgi = value;
+    else if (option == "--socket")
+      socketPath = value;
+    else if (option == "--dir")
+      directory = value;
+    else if (option == "--concurrency")
+      concurrency = atoi(value.c_str());
+    else if (option == "--writers")
+      writers = atoi(value.c_str());
+    else if (option == "--requests")
+      requests = atol(value.c_str());
+    else if (option == "--mix") {
+      if (!parseMix(value))
+        return (usage(argv[0]));
+    } else if (option == "--years")
+      years = atoi(value.c_str());
+    else if (option == "--size")
+      entrySize = atol(value.c_str());
+    else if (option == "--storage")
+      storage = value;
+    else
+      return (usage(argv[0]));
+  }
+  if (concurrency < 1 || requests < 1 || years < 1 || writers < 0 ||
+      writers > concurrency || (serve && (fastcgi || !socketPath.empty())) ||
+      (storage != "text" && storage != "segment" && storage != "sharded"))
+    return (usage(argv[0]));
+
+  char path[PATH_MAX];
+  if (cgi.empty())
+    cgi = "./index.cgi";
+  if (realpath(cgi.c_str(), path) == NULL) {
+    cerr << argv[0] << ": cannot find " << cgi << endl;
+    return (1);
+  }
+  cgi = path;
+  signal(SIGPIPE, SIG_IGN);
+
+  // without a directory a log is generated in a temporary one
+  char cwd[PATH_MAX], temporary[] = "/tmp/load-bench.XXXXXX";
+  bool generated = directory.empty();
+  if (generated && mkdtemp(temporary) != NULL)
+    directory = temporary;
+  if (getcwd(cwd, sizeof(cwd)) == NULL || directory.empty() ||
+      chdir(directory.c_str()) != 0) {
+    cerr << argv[0] << ": cannot use directory " << directory << endl;
+    return (1);
+  }
+
+  if (generated) {
+    CONFIG config;
+    configClear(config);
+    configSet(config, "log", storageLog(storage));
+    configSet(config, "base", "http://localhost/BoL/");
+    configSet(config, "administrator", "root@localhost");
+    configSet(config, "storage", storage);
+    if (!generateLog("log.dat", years, entrySize) ||
+        configWrite("bol.cfg", config) != OK ||
+        (storage != "text" &&
+         (configRead("bol.cfg", config) != OK ||
+          storeCreate(config.log, storage) != OK ||
+          storeOpen(config.log, storage) != OK ||
+          storeImport("log.dat") != OK))) {
+      cerr << argv[0] << ": cannot generate a log" << endl;
+      return (1);
+    }
+  }
+
+  map<string, string> before;
+  long count = 0;
+  if (readEntries(before, count) != OK || before.empty()) {
+    cerr << argv[0] << ": cannot read the log in " << directory << endl;
+    return (1);
+  }
+  for (map<string, string>::const_iterator it = before.begin();
+       it != before.end(); it++)
+    IDs.push_back(it->first);
+
+  // the persistent mode is started in the directory like a web server would
+  pid_t server = -1;
+  if (fastcgi && socketPath.empty()) {
+    socketPath = directory + "/load.sock";
+    unlink(socketPath.c_str());
+    char *serverArgv[] = {const_cast<char *>(cgi.c_str()),
+                          const_cast<char *>("--fastcgi"),
+                          const_cast<char *>(socketPath.c_str()), NULL};
+    if (posix_spawn(&server, cgi.c_str(), NULL, NULL, serverArgv, environ) !=
+        0) {
+      cerr << argv[0] << ": cannot start " << cgi << endl;
+      return (1);
+    }
+    for (int tries = 0; tries < 100 && access(socketPath.c_str(), F_OK) != 0;
+         tries++)
+      usleep(10000);
+  }
+
+  // the built-in server gets a port the kernel has just handed out
+  if (serve) {
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int probe = socket(AF_INET, SOCK_STREAM, 0);
+    if (probe >= 0 &&
+        bind(probe, reinterpret_cast<struct sockaddr *>(&address),
+             sizeof(address)) == 0 &&
+        getsockname(probe, reinterpret_cast<struct sockaddr *>(&address),
+                    &length) == 0)
+      port = ntohs(address.sin_port);
+    if (probe >= 0)
+      close(probe);
+
+    string listen = "127.0.0.1:" + to_string(port);
+    char *serverArgv[] = {const_cast<char *>(cgi.c_str()),
+                          const_cast<char *>("--serve"),
+                          const_cast<char *>(listen.c_str()), NULL};
+    if (port == 0 || posix_spawn(&server, cgi.c_str(), NULL, NULL, serverArgv,
+                                 environ) != 0) {
+      cerr << argv[0] << ": cannot start " << cgi << endl;
+      return (1);
+    }
+
+    int fd = -1;
+    address.sin_port = htons(port);
+    for (int tries = 0; tries < 100; tries++) {
+      fd = socket(AF_INET, SOCK_STREAM, 0);
+      if (connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+                  sizeof(address)) == 0)
+        break;
+      close(fd);
+      fd = -1;
+      usleep(10000);
+    }
+    if (fd >= 0)
+      close(fd);
+  }
+
+  remaining = requests;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  vector<thread> workers;
+  for (int i = 0; i < concurrency; i++)
+    workers.push_back(thread(worker, i));
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
+  double elapsed =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  if (server > 0) {
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    unlink(socketPath.c_str());
+  }
+
+  // saves only touch existing entries: every entry must still be there,
+  // holding either its old text or the text of one of its saves
+  map<string, string> after;
+  long countAfter = 0;
+  ERROR_CODE state = readEntries(after, countAfter);
+  long lost = 0, corrupt = 0, missing = 0, saves = 0;
+  for (map<string, string>::const_iterator it = before.begin();
+       it != before.end(); it++) {
+    map<string, string>::const_iterator now = after.find(it->first);
+    map<string, set<string>>::const_iterator saved = posted.find(it->first);
+    if (now == after.end())
+      missing++;
+    else if (saved == posted.end()) {
+      if (now->second != it->second)
+        corrupt++;
+    } else if (saved->second.count(now->second) == 0) {
+      if (now->second == it->second)
+        lost++;
+      else
+        corrupt++;
+    }
+  }
+  for (map<string, set<string>>::const_iterator it = posted.begin();
+       it != posted.end(); it++)
+    saves += it->second.size();
+
+  if (chdir(cwd) != 0)
+    return (1);
+  if (generated)
+    removeDirectory(directory);
+
+  cout << requests << " requests, concurrency " << concurrency;
+  if (writers > 0)
+    cout << " (" << writers << " saving)";
+  cout << ", "
+       << (port > 0 ? "HTTP" : socketPath.empty() ? "CGI" : "FastCGI") << ", "
+       << IDs.size() << " entries" << endl;
+
+  long failed = 0;
+  cout << left << setw(8) << "action" << right << setw(8) << "count"
+       << setw(8) << "errors" << setw(10) << "p50 ms" << setw(10) << "p95 ms"
+       << setw(10) << "p99 ms" << setw(10) << "max ms" << endl;
+  for (int action = 0; action <= ACTIONS; action++) {
+    vector<double> times;
+    long errors = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+      if (action < ACTIONS && samples[i].action != action)
+        continue;
+      times.push_back(samples[i].seconds * 1e3);
+      errors += !samples[i].ok;
+    }
+    if (times.empty())
+      continue;
+    sort(times.begin(), times.end());
+    if (action == ACTIONS)
+      failed = errors;
+
+    cout << left << setw(8) << (action < ACTIONS ? actionNames[action] : "all")
+         << right << setw(8) << times.size() << setw(8) << errors << fixed
+         << setprecision(2) << setw(10) << percentile(times, 0.50) << setw(10)
+         << percentile(times, 0.95) << setw(10) << percentile(times, 0.99)
+         << setw(10) << times.back() << endl;
+  }
+
+  cout << "throughput: " << setprecision(1) << samples.size() / elapsed
+       << " requests/s, error rate " << setprecision(2)
+       << 100.0 * failed / samples.size() << "%" << endl;
+  if (state != OK)
+    cout << "integrity: the log cannot be read after the run" << endl;
+  else
+    cout << "integrity: " << saves << " saves, " << countAfter << "/" << count
+         << " entries, " << missing << " missing, " << lost
+         << " lost updates, " << corrupt << " corrupt" << endl;
+
+  return (failed == 0 && state == OK && countAfter == count && missing == 0 &&
+                  lost == 0 && corrupt == 0
+              ? 0
+              : 1);
+}
@@ -0,0 +1,386 @@
+/**
+ *  @file   logger.cpp
+ *  @brief  Per-action benchmark on generated logs
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/actions.h"
+#include "../src/days.h"
+#include "../src/response.h"
+#include "../src/search.h"
+#include "../src/store.h"
+#include "generate.h"
+
+using namespace std;
+
+typedef struct {
+  string name;
+  int years;
+  size_t size;
+  size_t bytes;
+  size_t iterations;
+  double median;
+  double mean;
+} RESULT;
+
+bool discard(const char *, size_t length, void *context) {
+  *static_cast<size_t *>(context) += length;
+  return (true);
+}
+
+// one untimed call, then calls until seconds have passed and at least three
+// were timed; reports the median and mean
+template <typename F>
+RESULT measure(const string &name, F f, double seconds, size_t &output) {
+  RESULT result = {name, 0, 0, 0, 0, 0, 0};
+
+  f();
+  responseFlush();
+  output = 0;
+
+  vector<double> times;
+  double total = 0;
+  while (times.size() < 3 || total < seconds) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (f() != OK) {
+      cerr << name << ": failed" << endl;
+      exit(1);
+    }
+    responseFlush();
+    times.push_back(
+        chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    total += times.back();
+  }
+
+  sort(times.begin(), times.end());
+  result.iterations = times.size();
+  result.median = times[times.size() / 2] * 1e9;
+  result.mean = total / times.size() * 1e9;
+  result.bytes = output / times.size();
+
+  return (result);
+}
+
+void setQuery(const string &data) {
+  query = data;
+  formParse(query, queryFields);
+}
+
+void setStream(const string &data) {
+  stream = data;
+  formParse(stream, streamFields);
+}
+
+void run(int years, size_t size, const string &storage, int threads,
+         double seconds, vector<RESULT> &results) {
+  configClear(config);
+  config.log = storageLog(storage);
+  config.storage = storage;
+  config.threads = threads;
+  config.base = "http://localhost/BoL/";
+  config.administrator = "root@localhost";
+  self = "/index.cgi";
+  pageSettings();
+
+  // every run imports into a store of its own
+  if (storage == "sharded")
+    removeDirectory(config.log);
+
+  if (!generateLog("log.dat", years, size) ||
+      (storage != "text" &&
+       (storeCreate(config.log, storage) != OK || openStore() != OK ||
+        storeImport("log.dat") != OK))) {
+    cerr << "cannot generate a " << storage << " log" << endl;
+    exit(1);
+  }
+
+  unsigned int seed = 7;
+  string ID = dayID(dayKey(newestID) - years * 365 / 2),
+         content = generateText(size, seed), encoded = encodeURL(content);
+  uint32_t next = dayKey(newestID);
+
+  size_t output = 0;
+  responseBegin(discard, &output);
+
+  vector<RESULT> measured;
+  setQuery("");
+  measured.push_back(
+      measure("doRead", [&]() { return (doRead(ID)); }, seconds, output));
+  measured.push_back(measure(
+      "doView/single", [&]() { return (doView(ID)); }, seconds, output));
+  measured.push_back(
+      measure("doView/all", [&]() { return (doView("")); }, seconds, output));
+  setQuery("limit=20");
+  measured.push_back(
+      measure("doView/page", [&]() { return (doView("")); }, seconds, output));
+  setQuery("match=coffee");
+  measured.push_back(measure(
+      "doSearch", [&]() { return (doSearch("000000")); }, seconds, output));
+  setQuery("match=coffee+walk&order=rank");
+  measured.push_back(measure(
+      "doSearch/rank", [&]() { return (doSearch("000000")); }, seconds,
+      output));
+
+  // the same pages gzip compressed, the difference is the added CPU
+  setQuery("");
+  measured.push_back(measure(
+      "gzip/view/all",
+      [&]() {
+        responseCompress(compressionLevel());
+        ERROR_CODE state = doView("");
+        responseFinish();
+        return (state);
+      },
+      seconds, output));
+  setQuery("match=coffee");
+  measured.push_back(measure(
+      "gzip/search",
+      [&]() {
+        responseCompress(compressionLevel());
+        ERROR_CODE state = doSearch("000000");
+        responseFinish();
+        return (state);
+      },
+      seconds, output));
+  setQuery("");
+
+  ostringstream sink;
+  size_t kept = 0;
+  measured.push_back(measure(
+      "decodeURL",
+      [&]() {
+        kept += decodeURL(encoded).length();
+        return (OK);
+      },
+      seconds, output));
+  measured.push_back(measure(
+      "toHTML",
+      [&]() {
+        sink.str("");
+        toHTML(sink, content);
+        return (OK);
+      },
+      seconds, output));
+  measured.push_back(measure(
+      "highlight",
+      [&]() {
+        kept += highlight(content, "coffee").length();
+        return (OK);
+      },
+      seconds, output));
+
+  // the log grows from here on
+  setStream("content=" + encoded);
+  measured.push_back(
+      measure("doSave", [&]() { return (doSave(ID)); }, seconds, output));
+  measured.push_back(measure(
+      "newEntry", [&]() { return (newEntry(dayID(++next), content)); },
+      seconds, output));
+
+  responseEnd();
+  if (kept == 0)
+    exit(1);
+
+  for (size_t i = 0; i < measured.size(); i++) {
+    measured[i].years = years;
+    measured[i].size = size;
+    results.push_back(measured[i]);
+  }
+}
+
+void writeJSON(ostream &out, const string &storage,
+               const vector<RESULT> &results) {
+  out << "{\n  \"kernel\": \"" << searchKernel() << "\",\n  \"storage\": \""
+      << storage << "\",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+    out << "    {\"name\": \"" << results[i].name
+        << "\", \"years\": " << results[i].years
+        << ", \"size\": " << results[i].size
+        << ", \"output\": " << results[i].bytes
+        << ", \"iterations\": " << results[i].iterations << fixed
+        << setprecision(0) << ", \"median_ns\": " << results[i].median
+        << ", \"mean_ns\": " << results[i].mean << "}"
+        << (i + 1 < results.size() ? "," : "") << '\n';
+  out << "  ]\n}\n";
+}
+
+string field(const string &line, const string &name) {
+  size_t at = line.find("\"" + name + "\": ");
+  if (at == string::npos)
+    return ("");
+  at += name.length() + 4;
+  if (line[at] == '"')
+    return (line.substr(at + 1, line.find('"', at + 1) - at - 1));
+  return (line.substr(at, line.find_first_of(",}", at) - at));
+}
+
+// reads back the results written by writeJSON, one per line
+bool readJSON(const string &file, vector<RESULT> &results) {
+  ifstream ifstr(file.c_str());
+  if (!ifstr.good())
+    return (false);
+
+  string line;
+  while (getline(ifstr, line)) {
+    if (field(line, "name").empty())
+      continue;
+    RESULT result = {field(line, "name"),
+                     atoi(field(line, "years").c_str()),
+                     strtoul(field(line, "size").c_str(), NULL, 10),
+                     strtoul(field(line, "output").c_str(), NULL, 10),
+                     strtoul(field(line, "iterations").c_str(), NULL, 10),
+                     atof(field(line, "median_ns").c_str()),
+                     atof(field(line, "mean_ns").c_str())};
+    results.push_back(result);
+  }
+
+  return (true);
+}
+
+vector<long> numbers(const string &list) {
+  vector<long> values;
+  istringstream istrstr(list);
+  string value;
+  while (getline(istrstr, value, ','))
+    values.push_back(atol(value.c_str()));
+  return (values);
+}
+
+int usage(const char *program) {
+  cerr << "usage: " << program
+       << " [--years 1,5,20] [--size 1000] [--storage text|segment|sharded]"
+       << endl
+       << "       [--threads n]"
+       << " [--time seconds] [--json file] [--compare baseline.json]"
+       << " [--threshold percent]" << endl
+       << "       " << program << " --generate file [--years n] [--size bytes]"
+       << endl;
+  return (2);
+}
+
+int main(int argc, char *argv[]) {
+  vector<long> years = {1, 5, 20}, sizes = {1000};
+  string storage = "text", json, baseline, generated;
+  double seconds = 0.2, threshold = 10;
+  int threads = -1;
+
+  for (int i = 1; i < argc; i++) {
+    string option = argv[i];
+    if (i + 1 >= argc)
+      return (usage(argv[0]));
+    string value = argv[++i];
+    if (option == "--years")
+      years = numbers(value);
+    else if (option == "--size")
+      sizes = numbers(value);
+    else if (option == "--storage")
+      storage = value;
+    else if (option == "--threads")
+      threads = atoi(value.c_str());
+    else if (option == "--time")
+      seconds = atof(value.c_str());
+    else if (option == "--json")
+      json = value;
+    else if (option == "--compare")
+      baseline = value;
+    else if (option == "--threshold")
+      threshold = atof(value.c_str());
+    else if (option == "--generate")
+      generated = value;
+    else
+      return (usage(argv[0]));
+  }
+  if (years.empty() || sizes.empty() ||
+      (storage != "text" && storage != "segment" && storage != "sharded"))
+    return (usage(argv[0]));
+
+  if (!generated.empty())
+    return (generateLog(generated, years[0], sizes[0]) ? 0 : 1);
+
+  vector<RESULT> previous;
+  if (!baseline.empty() && !readJSON(baseline, previous)) {
+    cerr << argv[0] << ": cannot read " << baseline << endl;
+    return (1);
+  }
+
+  char directory[] = "/tmp/logger-bench.XXXXXX";
+  char cwd[4096];
+  if (getcwd(cwd, sizeof(cwd)) == NULL || mkdtemp(directory) == NULL ||
+      chdir(directory) != 0) {
+    cerr << argv[0] << ": cannot create a work directory" << endl;
+    return (1);
+  }
+
+  vector<RESULT> results;
+  for (size_t y = 0; y < years.size(); y++)
+    for (size_t s = 0; s < sizes.size(); s++)
+      run(years[y], sizes[s], storage, threads, seconds, results);
+
+  if (chdir(cwd) != 0)
+    return (1);
+  removeDirectory(directory);
+
+  cout << "kernel: " << searchKernel() << ", storage: " << storage << endl;
+  cout << left << setw(15) << "action" << right << setw(6) << "years"
+       << setw(7) << "size" << setw(11) << "output" << setw(8) << "runs"
+       << setw(12) << "median us";
+  if (!previous.empty())
+    cout << setw(12) << "baseline" << setw(9) << "change";
+  cout << endl;
+
+  int regressions = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    const RESULT &result = results[i];
+    cout << left << setw(15) << result.name << right << setw(6)
+         << result.years << setw(7) << result.size << setw(11) << result.bytes
+         << setw(8) << result.iterations << setw(12) << fixed
+         << setprecision(1) << result.median / 1e3;
+
+    for (size_t p = 0; p < previous.size(); p++) {
+      if (previous[p].name != result.name ||
+          previous[p].years != result.years || previous[p].size != result.size)
+        continue;
+      double change = (result.median / previous[p].median - 1) * 100;
+      cout << setw(12) << previous[p].median / 1e3 << setw(8) << showpos << change << "%" << noshowpos;
+      if (change > threshold) {
+        cout << "  REGRESSION";
+        regressions++;
+      }
+      break;
+    }
+    cout << endl;
+  }
+
+  if (!json.empty()) {
+    ofstream ofstr(json.c_str(), ios::out | ios::trunc);
+    writeJSON(ofstr, storage, results);
+    if (ofstr.fail()) {
+      cerr << argv[0] << ": cannot write " << json << endl;
+      return (1);
+    }
+  }
+
+  if (regressions > 0) {
+    cout << regressions << " regression(s) above " << threshold << "%"
+         << endl;
+    return (1);
+  }
+
+  return (0);
+}
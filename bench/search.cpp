@@ -0,0 +1,141 @@
+/**
+ *  @file   search.cpp
+ *  @brief  Search kernel microbenchmark
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../src/search.h"
+
+using namespace std;
+
+// the line matcher doSearch used before the search kernel
+int legacyFind(string match, string str) {
+  for (size_t i = 0; i < str.length(); i++) {
+    if (str.at(i) == toupper(match.at(0)) ||
+        str.at(i) == tolower(match.at(0))) {
+      if ((str.length() - i) < match.length())
+        return (0);
+      else {
+        size_t j = 0;
+        while (str.at(i + j) == toupper(match.at(j)) ||
+               str.at(i + j) == tolower(match.at(j))) {
+          if (j == match.length() - 1)
+            return (1);
+          j++;
+        }
+      }
+    }
+  }
+  return (0);
+}
+
+string generate(size_t size) {
+  const char *words[] = {"the",   "coffee", "Thesis", "draft",  "meeting",
+                         "notes", "Lunch",  "with",   "review", "<b>bold</b>",
+                         "and",   "a",      "long",   "walk",   "EVENING"};
+  const size_t nWords = sizeof(words) / sizeof(words[0]);
+
+  string text;
+  text.reserve(size + 128);
+  unsigned int seed = 42;
+  while (text.length() < size) {
+    for (size_t column = 0; column < 72;) {
+      seed = seed * 1103515245 + 12345;
+      const char *word = words[(seed >> 16) % nWords];
+      text += word;
+      text += ' ';
+      column += strlen(word) + 1;
+    }
+    text += '\n';
+  }
+
+  return (text);
+}
+
+size_t legacyLines(const string &text, const string &match) {
+  istringstream istrstr(text);
+  string line;
+  size_t matched = 0;
+  while (getline(istrstr, line))
+    matched += legacyFind(match, line);
+  return (matched);
+}
+
+size_t kernelLines(const string &text, const string &match) {
+  SEARCH_PATTERN pattern;
+  searchCompile(match, pattern);
+
+  size_t matched = 0, found, from = 0;
+  while ((found = searchFind(pattern, text, from)) != string_view::npos) {
+    size_t end = text.find('\n', found);
+    if (end == string::npos)
+      end = text.length();
+    if (found + match.length() <= end)
+      matched++;
+    from = found + match.length() <= end ? end + 1 : found + 1;
+  }
+  return (matched);
+}
+
+template <typename F> double seconds(F f, int iterations, size_t &result) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    result = f();
+  return (chrono::duration<double>(chrono::steady_clock::now() - start)
+              .count() /
+          iterations);
+}
+
+int main(int argc, char *argv[]) {
+  size_t megabytes = argc > 1 ? atoi(argv[1]) : 8;
+  int iterations = argc > 2 ? atoi(argv[2]) : 3;
+
+  string text = generate(megabytes << 20);
+  const char *matches[] = {"coffee", "THESIS draft", "e", "zzzz",
+                           "<b>bold</b> and"};
+
+  cout << "log: " << megabytes << " MiB, " << iterations << " iterations"
+       << endl;
+  cout << left << setw(18) << "pattern" << setw(10) << "kernel" << right
+       << setw(10) << "lines" << setw(12) << "MiB/s" << setw(10) << "speedup"
+       << endl;
+
+  const char *kernels[] = {"avx2", "sse2", "scalar"};
+  for (size_t m = 0; m < sizeof(matches) / sizeof(matches[0]); m++) {
+    string match = matches[m];
+    size_t expected = 0;
+    double legacy = seconds([&]() { return (legacyLines(text, match)); },
+                            iterations, expected);
+    cout << left << setw(18) << match << setw(10) << "legacy" << right
+         << setw(10) << expected << setw(12) << fixed << setprecision(1)
+         << megabytes / legacy << setw(10) << 1.0 << endl;
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+      if (!searchSelect(kernels[k]))
+        continue;
+
+      size_t lines = 0;
+      double elapsed = seconds([&]() { return (kernelLines(text, match)); },
+                               iterations, lines);
+      cout << left << setw(18) << match << setw(10) << kernels[k] << right
+           << setw(10) << lines << setw(12) << megabytes / elapsed << setw(10)
+           << legacy / elapsed << (lines != expected ? "  MISMATCH" : "")
+           << endl;
+      if (lines != expected)
+        return (1);
+    }
+  }
+
+  return (0);
+}
@@ -0,0 +1,205 @@
+/**
+ *  @file   text.cpp
+ *  @brief  Text transform microbenchmark
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../src/request.h"
+#include "../src/search.h"
+#include "../src/template.h"
+
+using namespace std;
+
+// the transforms as they were before they became single pass
+
+string legacyDecodeURL(string URLencoded) {
+  for (size_t idx = 0; idx < URLencoded.length(); idx++) {
+    if (URLencoded[idx] == '+')
+      URLencoded.replace(idx, 1, " ");
+    else if (URLencoded[idx] == '%')
+      URLencoded.replace(
+          idx, 3, 1,
+          (char)strtol(URLencoded.substr(idx + 1, 2).c_str(), NULL, 16));
+  }
+  return (URLencoded);
+}
+
+string legacyToHTML(string noneHTML) {
+  for (size_t idx = 0; idx < noneHTML.length(); idx++) {
+    if (noneHTML[idx] == '\n') {
+      if (noneHTML[idx - 1] == '\r')
+        noneHTML.erase(--idx, 1);
+      noneHTML.replace(idx, 1, "<br />\n");
+      idx = idx + 6;
+    } else if (noneHTML[idx] == ' ') {
+      if (noneHTML[idx + 1] == ' ') {
+        noneHTML.replace(idx + 1, 1, "&nbsp;");
+        idx = idx + 6;
+      }
+    }
+  }
+  return (noneHTML);
+}
+
+string legacyHighlight(string content, string match) {
+  string workString = "";
+  int contentLen = content.length(), matchLen = match.length();
+
+  for (int pos = 0; pos < contentLen; pos++) {
+    if (content.at(pos) == '<') {
+      while (content.at(pos) != '>') {
+        workString += content.at(pos);
+        if (++pos > contentLen)
+          return (workString);
+      }
+      workString += content.at(pos);
+    } else {
+      int seek = 0, postmp = pos;
+      while (tolower(content.at(postmp)) == tolower(match.at(seek))) {
+        if ((++postmp > contentLen - 1) || (++seek > matchLen - 1))
+          break;
+      }
+      if (seek == matchLen) {
+        workString += "<span class=\"highlight\" title=\"highlighted\">";
+        for (; pos < postmp; pos++)
+          workString += content.at(pos);
+        workString += "</span>";
+      }
+      workString += content.at(pos);
+    }
+  }
+  return (workString);
+}
+
+// entry text with CRLF line ends, double spaces and some markup
+string generate(size_t size) {
+  const char *words[] = {"the",   "coffee", "Thesis", "draft", "meeting",
+                         "notes", "Lunch",  "with",   "50%",   "<b>bold</b>",
+                         "and",   "a",      "long",   " walk", "EVENING"};
+  const size_t nWords = sizeof(words) / sizeof(words[0]);
+
+  string text;
+  text.reserve(size + 128);
+  unsigned int seed = 42;
+  while (text.length() < size) {
+    for (size_t column = 0; column < 72;) {
+      seed = seed * 1103515245 + 12345;
+      const char *word = words[(seed >> 16) % nWords];
+      text += word;
+      text += ' ';
+      column += strlen(word) + 1;
+    }
+    text += "\r\n";
+  }
+  text.resize(size - 1);
+  text += '\n';
+
+  return (text);
+}
+
+string encodeURL(const string &text) {
+  string encoded;
+  for (size_t i = 0; i < text.length(); i++) {
+    unsigned char c = text[i];
+    if (c == ' ')
+      encoded += '+';
+    else if (isalnum(c))
+      encoded += c;
+    else {
+      char hex[4];
+      snprintf(hex, sizeof(hex), "%%%02X", c);
+      encoded += hex;
+    }
+  }
+  return (encoded);
+}
+
+// repeats f for at least a tenth of a second, returns nanoseconds per byte
+template <typename F> double nsPerByte(F f, size_t bytes, string &result) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  double elapsed;
+  int iterations = 0;
+  do {
+    result = f();
+    iterations++;
+    elapsed =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  } while (elapsed < 0.1);
+
+  return (elapsed * 1e9 / iterations / bytes);
+}
+
+int main(int argc, char *argv[]) {
+  // the legacy decodeURL and toHTML are quadratic, larger inputs take minutes
+  size_t legacyLimit = argc > 1 ? atol(argv[1]) : 128 << 10;
+  const size_t sizes[] = {1 << 10, 10 << 10, 100 << 10, 1 << 20, 10 << 20};
+  const char *names[] = {"decodeURL", "toHTML", "highlight"};
+
+  cout << "kernel: " << searchKernel() << ", legacy up to " << legacyLimit
+       << " bytes for decodeURL and toHTML" << endl;
+  cout << left << setw(12) << "transform" << right << setw(10) << "bytes"
+       << setw(14) << "legacy ns/B" << setw(12) << "ns/B" << setw(10)
+       << "speedup" << endl;
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    string text = generate(sizes[s]), encoded = encodeURL(text);
+
+    for (int n = 0; n < 3; n++) {
+      string expected, result;
+      double legacy = 0, elapsed = 0;
+      switch (n) {
+      case 0:
+        if (encoded.length() <= legacyLimit)
+          legacy = nsPerByte([&]() { return (legacyDecodeURL(encoded)); },
+                             encoded.length(), expected);
+        elapsed = nsPerByte([&]() { return (decodeURL(encoded)); },
+                            encoded.length(), result);
+        break;
+      case 1:
+        if (text.length() <= legacyLimit)
+          legacy = nsPerByte([&]() { return (legacyToHTML(text)); },
+                             text.length(), expected);
+        elapsed = nsPerByte(
+            [&]() {
+              ostringstream out;
+              toHTML(out, text);
+              return (out.str());
+            },
+            text.length(), result);
+        break;
+      default:
+        legacy = nsPerByte([&]() { return (legacyHighlight(text, "coffee")); },
+                           text.length(), expected);
+        elapsed = nsPerByte([&]() { return (highlight(text, "coffee")); },
+                            text.length(), result);
+      }
+
+      cout << left << setw(12) << names[n] << right << setw(10)
+           << (n == 0 ? encoded.length() : text.length()) << fixed
+           << setprecision(2);
+      if (legacy > 0)
+        cout << setw(14) << legacy << setw(12) << elapsed << setw(10)
+             << legacy / elapsed;
+      else
+        cout << setw(14) << "-" << setw(12) << elapsed << setw(10) << "-";
+      bool mismatch = legacy > 0 && result != expected;
+      cout << (mismatch ? "  MISMATCH" : "") << endl;
+      if (mismatch)
+        return (1);
+    }
+  }
+
+  return (0);
+}
@@ -0,0 +1,1007 @@
+/**
+ *  @file   actions.cpp
+ *  @brief  Request handlers and page rendering
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "actions.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "days.h"
+#include "fragments.h"
+#include "pool.h"
+#include "search.h"
+#include "stats.h"
+#include "store.h"
+
+const char *entries = "<!--- BEGIN ENTRIES >";
+const char *endEntries = "<!--- END ENTRIES >";
+
+const char *entryID = "<!--- ENTRY ID = ";
+
+const char *contentID = "<!--- CONTENT ID = ";
+const char *endContent = "<!--- END CONTENT >";
+
+string self;
+
+CONFIG config;
+string query;
+string stream;
+
+FORM queryFields, streamFields;
+
+TEMPLATE_VALUES page;
+
+ERROR_CODE doRead(string ID) {
+  ERROR_CODE state = openStore();
+  if (state != OK)
+    return (state);
+
+  long pos = storeFind(ID);
+  if (pos < 0) {
+    openEntry(ID);
+    return (OK);
+  }
+
+  string_view content;
+  state = storeRead(pos, content);
+  if (state != OK)
+    return (state);
+
+  openEntry(ID, content);
+
+  return (OK);
+}
+
+ERROR_CODE doView(string ID = "") {
+  ERROR_CODE state = openStore();
+  if (state != OK)
+    return (state);
+
+  string limit(formRaw(queryFields, "limit"));
+  if (ID.empty() && !limit.empty())
+    return (doPage(atoi(limit.c_str()),
+                   string(formRaw(queryFields, "cursor")),
+                   string(formRaw(queryFields, "direction")) == "newer"));
+
+  string_view content;
+  if (ID.empty()) {
+    vector<long> positions;
+    if ((state = storeAll(positions)) != OK)
+      return (state);
+
+    return (viewEntries(positions));
+  }
+
+  long pos = storeFind(ID);
+  if (pos < 0)
+    return (NOT_FOUND);
+
+  state = storeRead(pos, content);
+  if (state != OK)
+    return (state);
+
+  PREV_NEXT prev_next = {storeID(storeNeighbour(pos, -1)),
+                         storeID(storeNeighbour(pos, 1))};
+
+  viewEntry(ID, content, prev_next);
+  return (OK);
+}
+
+ERROR_CODE doPage(int limit, string cursor, bool newer) {
+  if (limit <= 0)
+    return (NO_QUERY);
+
+  // the cursor is the key of the last entry on the page the link is on, or
+  // going newer of the first one
+  uint32_t key = UINT32_MAX;
+  if (!cursor.empty()) {
+    char *end;
+    key = strtoul(cursor.c_str(), &end, 10);
+    if (*end != '\0' || key == 0)
+      return (NO_QUERY);
+  } else
+    newer = false;
+
+  // one entry more than fits tells whether there is a page beyond, a newer
+  // page that would reach the newest entry is the first page
+  vector<long> positions;
+  if (newer) {
+    storePage(key, false, limit + 1, positions);
+    if (positions.size() > static_cast<size_t>(limit)) {
+      positions.resize(limit);
+      reverse(positions.begin(), positions.end());
+    } else {
+      positions.clear();
+      key = UINT32_MAX;
+      newer = false;
+    }
+  }
+  if (!newer)
+    storePage(key, true, limit + 1, positions);
+
+  size_t shown = min(positions.size(), static_cast<size_t>(limit));
+  ERROR_CODE state =
+      viewEntries(vector<long>(positions.begin(), positions.begin() + shown));
+  if (state != OK)
+    return (state);
+
+  // the links carry the keys of the first and the last entry shown
+  uint32_t first = key == UINT32_MAX ? 0
+                   : shown                ? storeKey(positions[0])
+                                          : key;
+  bool older = newer || positions.size() > shown;
+  pageFooter(limit, first, older ? storeKey(positions[shown - 1]) : 0);
+
+  return (OK);
+}
+
+ERROR_CODE doRange(string from, string to) {
+  ERROR_CODE state = openStore();
+  if (state != OK)
+    return (state);
+
+  // an open end runs to the first or last entry
+  uint32_t first = from.empty() ? 1 : dayKey(from),
+           last = to.empty() ? UINT32_MAX : dayKey(to);
+  if (first == 0 || last == 0)
+    return (NO_QUERY);
+
+  vector<long> positions;
+  storeRange(first, last, positions);
+
+  return (viewEntries(positions));
+}
+
+ERROR_CODE doSearch(string ID = "") {
+  if (!ID.empty()) {
+    ERROR_CODE state = openStore();
+    if (state != OK)
+      return (state);
+
+    string match;
+    match = formValue(queryFields, "match");
+    if (match.empty())
+      return (OK);
+
+    if (formRaw(queryFields, "order") == "rank")
+      return (doRank(match));
+
+    matchedHeader(match);
+    statsPhase(STATS_SEARCH);
+
+    SEARCH_PATTERN pattern;
+    searchCompile(match, pattern);
+
+    // the trigram index narrows the entries down to those that can match
+    vector<long> candidates;
+    state = storeCandidates(match, candidates);
+    if (state != OK)
+      return (state);
+
+    vector<string_view> contents(candidates.size());
+    size_t bytes = 0;
+    for (size_t c = 0; c < candidates.size(); c++) {
+      state = storeRead(candidates[c], contents[c]);
+      if (state != OK)
+        return (state);
+      bytes += contents[c].length();
+    }
+
+    // Runs of entries of about the same size are searched on as many
+    // threads, a large log being worth it. The lines found are shown in
+    // the order of the log afterwards, as a single thread would have.
+    int threads = poolThreads(config.threads, bytes);
+    vector<size_t> chunks(1, 0);
+    for (size_t c = 0, chunk = 0; c < candidates.size(); c++) {
+      chunk += contents[c].length();
+      if (chunk * threads >= bytes * chunks.size()) {
+        chunks.push_back(c + 1);
+        if (chunks.size() > static_cast<size_t>(threads))
+          break;
+      }
+    }
+    chunks.back() = candidates.size();
+
+    vector<vector<SEARCH_LINE>> found(candidates.size());
+    vector<int> visited(candidates.size());
+    poolRun(chunks.size() - 1, threads, [&](size_t chunk) {
+      for (size_t c = chunks[chunk]; c < chunks[chunk + 1]; c++)
+        visited[c] = searchLines(pattern, contents[c], found[c]);
+    });
+
+    uint64_t lines = 0;
+    for (size_t c = 0; c < candidates.size(); c++)
+      lines += visited[c];
+    statsCount(STATS_LINES, lines);
+
+    statsPhase(STATS_RENDER);
+    int matched = 0;
+    for (size_t c = 0; c < candidates.size(); c++)
+      for (size_t i = 0; i < found[c].size(); i++, matched++)
+        addMatched(contents[c].substr(found[c][i].begin, found[c][i].length),
+                   found[c][i].at, match, i == 0 ? storeID(candidates[c]) : "");
+
+    matchedFooter(matched);
+  }
+
+  return (OK);
+}
+
+ERROR_CODE doRank(string match) {
+  // number of best matching entries shown
+  const size_t limit = 25;
+
+  vector<WORDS_HIT> hits;
+  STATS_PHASE phase = statsPhase(STATS_SEARCH);
+  ERROR_CODE state = storeRank(match, limit, hits);
+  statsPhase(phase);
+  if (state != OK)
+    return (state);
+
+  vector<string> terms;
+  wordsTerms(match, terms);
+
+  matchedHeader(match);
+
+  string_view content;
+  for (size_t i = 0; i < hits.size(); i++) {
+    state = storeRead(storeFind(hits[i].ID), content);
+    if (state != OK)
+      return (state);
+
+    // show the first line holding one of the words as a whole word
+    size_t found = wordsFind(content, terms), begin, end;
+    if (found == content.length())
+      found = 0;
+
+    begin = content.rfind('\n', found);
+    begin = begin == string_view::npos || begin == found ? 0 : begin + 1;
+    if ((end = content.find('\n', found)) == string_view::npos)
+      end = content.length();
+
+    addMatched(content.substr(begin, end - begin),
+               count(content.begin(), content.begin() + begin, '\n') + 1,
+               match, hits[i].ID);
+  }
+
+  matchedFooter(hits.size());
+
+  return (OK);
+}
+
+ERROR_CODE doSave(string ID = "") {
+  ERROR_CODE state = openStore();
+  if (state != OK)
+    return (state);
+
+  STATS_PHASE phase = statsPhase(STATS_SAVE);
+  if (storeFind(ID) >= 0) {
+    state = storeWrite(ID, formValue(streamFields, "content"));
+    fragmentsForget(ID);
+    fragmentsForget("");
+  } else if (ID == getID())
+    state = newEntry(getID(), formValue(streamFields, "content"));
+  else
+    state = NOT_FOUND;
+  statsPhase(phase);
+
+  return (state);
+}
+
+// a new entry also changes the navigation of the entries around it, and
+// like any save every page kept under ""
+ERROR_CODE newEntry(string ID, string content) {
+  ERROR_CODE state = storeWrite(ID, content);
+
+  long pos = storeFind(ID);
+  fragmentsForget(ID);
+  fragmentsForget(storeID(storeNeighbour(pos, -1)));
+  fragmentsForget(storeID(storeNeighbour(pos, 1)));
+  fragmentsForget("");
+
+  return (state);
+}
+
+ERROR_CODE openStore(void) {
+  STATS_PHASE phase = statsPhase(STATS_OPEN);
+  ERROR_CODE state = storeOpen(config.log, config.storage);
+  statsPhase(phase);
+  return (state);
+}
+
+// The ETag of a view or search covers everything the page is rendered
+// from apart from the query: the log, bol.cfg, the theme and the year in
+// the footer. modified is the newest of the files among them, or 0 while
+// its second lasts and another save could still go unnoticed.
+ERROR_CODE pageValidators(string &etag, time_t &modified) {
+  ERROR_CODE state = openStore();
+  if (state != OK)
+    return (state);
+
+  const struct stat &log = storeStat();
+  string stamp = templateStamp(modified);
+  stamp += ' ' + to_string(log.st_dev) + ':' + to_string(log.st_ino) + ':' +
+           to_string(log.st_size) + ':' + to_string(log.st_mtim.tv_sec) +
+           '.' + to_string(log.st_mtim.tv_nsec);
+  stamp += ' ' + to_string(config.f_stat.st_ino) + ':' +
+           to_string(config.f_stat.st_size) + ':' +
+           to_string(config.f_stat.st_mtim.tv_sec) + '.' +
+           to_string(config.f_stat.st_mtim.tv_nsec);
+
+  time_t t = time(NULL);
+  struct tm stm = *localtime(&t);
+  stamp += ' ' + to_string(stm.tm_year);
+
+  char hex[19];
+  snprintf(hex, sizeof(hex), "%016zx", hash<string>()(stamp));
+  etag = string("\"") + hex + "\"";
+  modified = max(modified, max(log.st_mtime, config.f_stat.st_mtime));
+  if (modified >= t)
+    modified = 0;
+
+  return (OK);
+}
+
+string getID(void) {
+  struct tm stm;
+  time_t t;
+  time(&t);
+  stm = *localtime(&t);
+
+  string ID;
+  ID = (itostr(stm.tm_mday).length() == 2 ? "" : "0") + itostr(stm.tm_mday) +
+       (itostr(stm.tm_mon + 1).length() == 2 ? "" : "0") +
+       itostr(stm.tm_mon + 1) + itostr(stm.tm_year + 1900);
+
+  return (ID);
+}
+
+string ascID(string ID) {
+
+  int month;
+  month = atoi(ID.substr(2, 2).c_str());
+
+  string asc;
+  if (ID.at(0) > '0')
+    asc = ID.substr(0, 2) + " ";
+  else
+    asc = ID.substr(1, 1) + " ";
+
+  switch (month) {
+  case 1:
+    asc += "January";
+    break;
+  case 2:
+    asc += "February";
+    break;
+  case 3:
+    asc += "March";
+    break;
+  case 4:
+    asc += "April";
+    break;
+  case 5:
+    asc += "May";
+    break;
+  case 6:
+    asc += "June";
+    break;
+  case 7:
+    asc += "July";
+    break;
+  case 8:
+    asc += "August";
+    break;
+  case 9:
+    asc += "September";
+    break;
+  case 10:
+    asc += "October";
+    break;
+  case 11:
+    asc += "November";
+    break;
+  case 12:
+    asc += "December";
+  };
+
+  asc += " " + ID.substr(4, 4);
+
+  return (asc);
+}
+
+string readID(string str) {
+  return (str.substr(str.find_first_of("=") + 2, 8));
+}
+
+// What every entry is rendered with apart from itself: the request-wide
+// values and the templates. Worked out for the first entry shown after
+// pageSettings().
+static string entryContext;
+
+static string fragmentKey(string_view content, const string &match,
+                          PREV_NEXT prev_next) {
+  if (entryContext.empty()) {
+    time_t modified;
+    string context = templateStamp(modified);
+    for (int slot = 0; slot < TEMPLATE_SLOTS; slot++)
+      context += string(1, '\0') + string(page[slot]);
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016zx", hash<string>()(context));
+    entryContext = hex;
+  }
+
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016zx", hash<string_view>()(content));
+  string key = entryContext + hex + match;
+  if (prev_next != NULL)
+    key += '\0' + prev_next[PREV] + '\0' + prev_next[NEXT];
+
+  return (key);
+}
+
+// The markup of an entry depends on nothing but its arguments and the page
+// values, which stay put while a page is rendered, so any thread can do it.
+static string renderEntry(const string &ID, string_view content,
+                          const string &match, PREV_NEXT prev_next) {
+
+  string highlighted;
+  if (!match.empty()) {
+    highlighted = highlight(content, match);
+    content = highlighted;
+  }
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string date = ascID(ID), previousDate, nextDate;
+  values[SLOT_ID] = ID;
+  values[SLOT_DATE] = date;
+  values[SLOT_CONTENT] = content;
+
+  // flags only need to be non-empty
+  if (prev_next != NULL) {
+    values[SLOT_NAVIGATION] = "1";
+    if (!prev_next[PREV].empty()) {
+      previousDate = ascID(prev_next[PREV]);
+      values[SLOT_PREVIOUS] = prev_next[PREV];
+      values[SLOT_PREVIOUS_DATE] = previousDate;
+    }
+    if (!prev_next[NEXT].empty()) {
+      nextDate = ascID(prev_next[NEXT]);
+      values[SLOT_NEXT] = prev_next[NEXT];
+      values[SLOT_NEXT_DATE] = nextDate;
+    }
+  }
+
+  ostringstream html;
+  templateRender(html, PAGE_ENTRY, values);
+  return (html.str());
+}
+
+// Entries are rendered once for each content, neighbours, highlight and
+// theme, after that they come from the fragment cache.
+void viewEntry(string ID, string_view content, PREV_NEXT prev_next) {
+
+  string match = formValue(queryFields, "highlight");
+  string key = fragmentKey(content, match, prev_next);
+  const string *cached = fragmentsFind(ID, key);
+  if (cached != NULL) {
+    cout << *cached;
+    return;
+  }
+
+  string html = renderEntry(ID, content, match, prev_next);
+  fragmentsAdd(ID, key, html);
+  cout << html;
+}
+
+// Like viewEntry for each of the entries at positions, in order. Those not
+// in the fragment cache are rendered on the pool when there are enough of
+// them, and every entry is written as soon as it is next. Workers run at
+// most POOL_WINDOW entries a thread ahead of the one being written.
+ERROR_CODE viewEntries(const vector<long> &positions) {
+  size_t count = positions.size(), bytes = 0;
+  vector<string> IDs(count), keys(count), rendered(count);
+  vector<string_view> contents(count);
+  vector<char> missing(count);
+
+  // the keys also settle the templates before other threads use them, an
+  // entry that cannot be read ends the page where it would have started
+  ERROR_CODE state = OK;
+  string match = formValue(queryFields, "highlight");
+  for (size_t i = 0; i < count; i++) {
+    if ((state = storeRead(positions[i], contents[i])) != OK) {
+      count = i;
+      break;
+    }
+
+    IDs[i] = storeID(positions[i]);
+    keys[i] = fragmentKey(contents[i], match, NULL);
+    missing[i] = !fragmentsHas(IDs[i], keys[i]);
+    if (missing[i])
+      bytes += contents[i].length();
+  }
+
+  int threads = poolThreads(config.threads, bytes);
+  poolStream(
+      count, threads, POOL_WINDOW * threads,
+      [&](size_t i) {
+        if (missing[i])
+          rendered[i] = renderEntry(IDs[i], contents[i], match, NULL);
+      },
+      [&](size_t i) {
+        // an entry can have been pushed out of the cache since it was found
+        const string *cached = fragmentsFind(IDs[i], keys[i]);
+        if (cached != NULL) {
+          cout << *cached;
+          return;
+        }
+
+        if (!missing[i])
+          rendered[i] = renderEntry(IDs[i], contents[i], match, NULL);
+        fragmentsAdd(IDs[i], keys[i], rendered[i]);
+        cout << rendered[i];
+        string().swap(rendered[i]);
+      });
+
+  return (state);
+}
+
+void openEntry(string ID, string_view content) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string date = ascID(ID);
+  values[SLOT_ID] = ID;
+  values[SLOT_DATE] = date;
+  values[SLOT_CONTENT] = content.substr(0, content.length() - 1);
+
+  templateRender(cout, PAGE_EDIT, values);
+}
+
+void matchedHeader(string match) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+  values[SLOT_MATCH] = match;
+
+  templateRender(cout, PAGE_RESULTS, values);
+}
+
+void addMatched(string_view content, int at, string match, string ID) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string date = ID.empty() ? "" : ascID(ID), line = itostr(at);
+  values[SLOT_ID] = ID;
+  values[SLOT_DATE] = date;
+  values[SLOT_MATCH] = match;
+  values[SLOT_CONTENT] = content;
+  values[SLOT_AT] = line;
+
+  templateRender(cout, PAGE_RESULT, values);
+}
+
+void matchedFooter(int matched) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string count = itostr(matched);
+  values[SLOT_MATCHED] = count;
+
+  templateRender(cout, PAGE_RESULTS_FOOTER, values);
+}
+
+void header(void) {
+  templateRender(cout, PAGE_HEADER, page);
+}
+
+void footer(void) {
+
+  struct tm stm;
+  time_t t;
+  time(&t);
+  stm = *localtime(&t);
+
+  char year[5];
+
+  strftime(year, 5, "%Y", &stm);
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+  values[SLOT_YEAR] = year;
+
+  templateRender(cout, PAGE_FOOTER, values);
+}
+
+void pageFooter(int limit, uint32_t newer, uint32_t older) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string size = itostr(limit), first = newer ? to_string(newer) : "",
+         cursor = older ? to_string(older) : "";
+  values[SLOT_LIMIT] = size;
+  values[SLOT_NEWER] = first;
+  values[SLOT_CURSOR] = cursor;
+
+  templateRender(cout, PAGE_PAGES, values);
+}
+
+int pageSize(void) {
+  // entries per page of View All, $page in bol.cfg
+  return (config.page > 0 ? config.page : 20);
+}
+
+int compressionLevel(void) {
+  // gzip level of the pages, $compression in bol.cfg, 0 turns it off
+  return (config.compression >= 0 ? min(config.compression, 9) : 1);
+}
+
+void menu(string match) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+  values[SLOT_MATCH] = match;
+
+  templateRender(cout, PAGE_MENU, values);
+}
+
+// request-wide values every page may use, looked up once per request
+void pageSettings(void) {
+  static string settings[TEMPLATE_SLOTS];
+
+  settings[SLOT_SELF] = self;
+  settings[SLOT_BASE] = config.base;
+  settings[SLOT_PLUGIN] = config.plugin;
+  settings[SLOT_SCHEME] = config.scheme;
+  settings[SLOT_ADMINISTRATOR] = config.administrator;
+  settings[SLOT_PAGE_SIZE] = itostr(pageSize());
+  for (int slot = 0; slot < TEMPLATE_SLOTS; slot++)
+    page[slot] = settings[slot];
+  entryContext = "";
+
+  // a theme can replace pages from a directory named after it
+  if (!settings[SLOT_PLUGIN].empty() && !settings[SLOT_SCHEME].empty())
+    templateTheme(settings[SLOT_PLUGIN] + settings[SLOT_SCHEME] + "/");
+  else
+    templateTheme("");
+}
+
+const char *errorString(ERROR_CODE code) {
+  switch (code) {
+  case CONFIG_READ:
+    return ("Unable to read from config file");
+  case CONFIG_WRITE:
+    return ("Unable to write to config file");
+  case IO_READ:
+    return ("Unable to read from log file");
+  case IO_WRITE:
+    return ("Unable to write to log file");
+  case NO_QUERY:
+    return ("Requested action unknown");
+  case NOT_FOUND:
+    return ("Entry not found");
+  case STRUCTURE:
+    return ("Structure fault in log file");
+  case TOO_LARGE:
+    return ("Request too large");
+  case INCOMPLETE:
+    return ("Request incomplete");
+  default:
+    return ("Unknown fault");
+  };
+}
+
+void errorMessage(string handle, ERROR_CODE code) {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string number = itostr(code);
+  values[SLOT_QUERY] = handle;
+  values[SLOT_CODE] = number;
+  values[SLOT_MESSAGE] = errorString(code);
+
+  templateRender(cout, PAGE_ERROR, values);
+}
+
+const string itostr(int i) {
+  ostringstream ostrstr;
+  ostrstr << i;
+  return (ostrstr.str());
+}
+
+const string ftostr(float f, int signif) {
+  ostringstream ostrstr;
+  ostrstr.setf(ios::fixed);
+  ostrstr << setprecision(signif) << f;
+  return (ostrstr.str());
+}
+
+ERROR_CODE saveConfig(const char *file, CONFIG &config) {
+  // start from what is on disk, options not on the form are kept
+  if (access(file, F_OK) == 0)
+    configCache(file, config);
+  configSet(config, "log", formValue(streamFields, "log"));
+  configSet(config, "base", formValue(streamFields, "base"));
+  configSet(config, "administrator",
+            formValue(streamFields, "administrator"));
+  configSet(config, "plugin", formValue(streamFields, "plugin"));
+  configSet(config, "scheme", formValue(streamFields, "scheme"));
+  return (configWrite(file, config));
+}
+
+ERROR_CODE doSetup() {
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+
+  string logStatus = filenew(config.log),
+         pluginStatus = dirstat(config.plugin),
+         themes = select(getOptions(decodeURL(config.plugin)),
+                         decodeURL(config.scheme));
+  values[SLOT_LOG] = config.log;
+  values[SLOT_LOG_STATUS] = logStatus;
+  values[SLOT_PLUGIN_STATUS] = pluginStatus;
+  values[SLOT_THEMES] = themes;
+
+  templateRender(cout, PAGE_SETUP, values);
+
+  return (OK);
+}
+
+static string milliseconds(const vector<uint32_t> &sorted, double fraction) {
+  size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+  return (ftostr(sorted[max(rank, static_cast<size_t>(1)) - 1] / 1e3, 2));
+}
+
+// Every action recorded in $stats, and the file it rotated to, with the
+// spread of the time spent in each phase and its average counters.
+ERROR_CODE doStats(void) {
+  vector<STATS_RECORD> records;
+  if (!config.stats.empty()) {
+    ERROR_CODE state = statsRead(config.stats, records);
+    if (state != OK && state != NOT_FOUND)
+      return (state);
+  }
+
+  map<string, vector<size_t>> actions;
+  for (size_t i = 0; i < records.size(); i++) {
+    string action(records[i].action,
+                  strnlen(records[i].action, sizeof(records[i].action)));
+    if (action.empty() ||
+        action.find_first_not_of("abcdefghijklmnopqrstuvwxyz ") !=
+        string::npos)
+      action = "other";
+    actions[action].push_back(i);
+  }
+
+  string rows;
+  for (map<string, vector<size_t>>::const_iterator it = actions.begin();
+       it != actions.end(); it++) {
+    const vector<size_t> &group = it->second;
+    double average[STATS_COUNTERS] = {};
+    for (size_t i = 0; i < group.size(); i++)
+      for (int counter = 0; counter < STATS_COUNTERS; counter++)
+        average[counter] +=
+            records[group[i]].counters[counter] / double(group.size());
+
+    string cached;
+    double shown = average[STATS_HITS] + average[STATS_MISSES];
+    if (shown > 0)
+      cached = ", " + ftostr(100 * average[STATS_HITS] / shown, 1) +
+               "% of the fragments looked up were cached";
+
+    rows += "  <tr>\n    <td colspan=\"6\">\n      <h2>" + it->first +
+            "</h2>\n      " + itostr(group.size()) +
+            " requests, on average " + ftostr(average[STATS_ENTRIES], 1) +
+            " entries and " + ftostr(average[STATS_LINES], 1) +
+            " lines visited, " + ftostr(average[STATS_BYTES_READ] / 1e3, 1) +
+            " KB read and " + ftostr(average[STATS_BYTES_WRITTEN] / 1e3, 1) +
+            " KB written" + cached + "\n    </td>\n  </tr>\n"
+            "  <tr>\n    <td><i>ms</i></td>\n"
+            "    <td align=\"right\"><i>mean</i></td>\n"
+            "    <td align=\"right\"><i>50%</i></td>\n"
+            "    <td align=\"right\"><i>95%</i></td>\n"
+            "    <td align=\"right\"><i>99%</i></td>\n"
+            "    <td align=\"right\"><i>max</i></td>\n  </tr>\n";
+
+    for (int phase = 0; phase < STATS_PHASES; phase++) {
+      vector<uint32_t> times;
+      double mean = 0;
+      for (size_t i = 0; i < group.size(); i++) {
+        times.push_back(records[group[i]].phases[phase]);
+        mean += times.back() / double(group.size());
+      }
+      sort(times.begin(), times.end());
+      if (times.back() == 0)
+        continue;
+
+      rows += string("  <tr>\n    <td>") + statsPhaseNames[phase] +
+              "</td>\n    <td align=\"right\">" + ftostr(mean / 1e3, 2) +
+              "</td>\n    <td align=\"right\">" +
+              milliseconds(times, 0.50) +
+              "</td>\n    <td align=\"right\">" +
+              milliseconds(times, 0.95) +
+              "</td>\n    <td align=\"right\">" +
+              milliseconds(times, 0.99) +
+              "</td>\n    <td align=\"right\">" +
+              milliseconds(times, 1.0) + "</td>\n  </tr>\n";
+    }
+  }
+
+  TEMPLATE_VALUES values;
+  copy(page, page + TEMPLATE_SLOTS, values);
+  values[SLOT_STATS] = rows;
+
+  templateRender(cout, PAGE_STATS, values);
+
+  return (OK);
+}
+
+string filestat(const string file) {
+  if (!file.empty()) {
+    if (access(file.c_str(), R_OK) != 0)
+      return (" <font color=\"#ff0000\">File not found!</font>");
+    else {
+      struct stat f_stat;
+      stat(file.c_str(), &f_stat);
+      if (f_stat.st_size < 1e3)
+        return (" size " + itostr(f_stat.st_size) + " bytes");
+      else
+        return (" size " + ftostr(f_stat.st_size / 1e3, 1) + " KB");
+    }
+  }
+  return ("");
+}
+
+string filenew(const string file) {
+
+  if (!file.empty()) {
+    if (access(file.c_str(), W_OK) != 0) {
+      storeCreate(file, config.storage);
+      return (" <b>new</b>");
+    } else {
+      struct stat f_stat;
+      stat(file.c_str(), &f_stat);
+      if (f_stat.st_size < 1e3)
+        return (" size " + itostr(f_stat.st_size) + " bytes");
+      else
+        return (" size " + ftostr(f_stat.st_size / 1e3, 1) + " kb");
+    }
+  }
+  return ("");
+}
+
+string dirstat(const string directory) {
+  if (!directory.empty()) {
+    if (access(directory.c_str(), F_OK) != 0)
+      return (" <font color=\"#ff0000\">Directory does not exist!</font>");
+  }
+  return ("");
+}
+
+string select(const string options, const string selected) {
+  string workString = "      <select class=\"select\" name=\"scheme\">", option;
+
+  string::size_type start = 0, end;
+
+  while (start < options.length()) {
+    end = options.find_first_of("&", start);
+    if (end == string::npos)
+      end = options.length();
+
+    option = options.substr(start, end - start);
+    workString += "\n        <option value=\"" + option + "\"";
+    if (selected == option)
+      workString += " selected=\"selected\"";
+    workString += ">" + option + "</option>";
+    start = end + 1;
+  }
+
+  workString += "\n      </select>";
+
+  return (workString);
+}
+
+string getOptions(const string directory) {
+  struct dirent **listing;
+  int n_files;
+  if ((n_files = scandir(directory.c_str(), &listing, NULL, alphasort)) < 0)
+    return ("");
+
+  string files = "";
+  for (int file_nr = 0; file_nr < n_files; file_nr++) {
+    if (strlen(listing[file_nr]->d_name) > 4) {
+      if (strcmp(listing[file_nr]->d_name + strlen(listing[file_nr]->d_name) -
+                     4,
+                 ".css") == 0) {
+        if (!files.empty())
+          files += '&';
+        files += string(listing[file_nr]->d_name)
+                     .substr(0, strlen(listing[file_nr]->d_name) - 4);
+      }
+    }
+  }
+
+  return (files);
+}
+
+// Writes a gzip copy next to every stylesheet, script and svg image in
+// directory that does not have an up to date one, for webservers that
+// serve those in place of the original (gzip_static, MultiViews).
+ERROR_CODE precompress(const string &directory, int level) {
+  struct dirent **listing;
+  int n_files;
+  if ((n_files = scandir(directory.c_str(), &listing, NULL, alphasort)) < 0)
+    return (IO_READ);
+
+  const char *types[] = {".css", ".js", ".svg"};
+  ERROR_CODE state = OK;
+  for (int file_nr = 0; file_nr < n_files; file_nr++) {
+    string name = listing[file_nr]->d_name;
+    free(listing[file_nr]);
+
+    bool listed = false;
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+      listed = listed || (name.length() > strlen(types[t]) &&
+                          name.compare(name.length() - strlen(types[t]),
+                                       string::npos, types[t]) == 0);
+
+    string file = directory + name, gz = file + ".gz";
+    struct stat f_stat, gz_stat;
+    if (!listed || state != OK || stat(file.c_str(), &f_stat) != 0 ||
+        (stat(gz.c_str(), &gz_stat) == 0 &&
+         gz_stat.st_mtime >= f_stat.st_mtime))
+      continue;
+
+    ifstream ifstr(file.c_str(), ios::in | ios::binary);
+    ostringstream content;
+    content << ifstr.rdbuf();
+    if (ifstr.fail()) {
+      state = IO_READ;
+      continue;
+    }
+
+    string tmp = gz + ".tmp." + to_string(getpid());
+    gzFile out = gzopen(tmp.c_str(), ("wb" + to_string(level)).c_str());
+    if (out == NULL ||
+        gzwrite(out, content.str().data(), content.str().length()) !=
+            static_cast<int>(content.str().length()) ||
+        gzclose(out) != Z_OK || rename(tmp.c_str(), gz.c_str()) != 0) {
+      unlink(tmp.c_str());
+      state = IO_WRITE;
+    }
+  }
+  free(listing);
+
+  return (state);
+}
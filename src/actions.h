@@ -0,0 +1,87 @@
+/**
+ *  @file   actions.h
+ *  @brief  Request handlers and page rendering
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef ACTIONS_H_
+#define ACTIONS_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+#include "logger.h"
+#include "request.h"
+#include "template.h"
+
+using namespace std;
+
+extern string self;
+
+extern CONFIG config;
+extern string query;
+extern string stream;
+
+extern FORM queryFields, streamFields;
+
+extern TEMPLATE_VALUES page;
+
+ERROR_CODE saveConfig(const char *file, CONFIG &config);
+
+ERROR_CODE doRead(string ID);
+ERROR_CODE doView(string ID);
+ERROR_CODE doPage(int limit, string cursor, bool newer = false);
+ERROR_CODE doRange(string from, string to);
+ERROR_CODE doSearch(string ID);
+ERROR_CODE doRank(string match);
+ERROR_CODE doSave(string ID);
+ERROR_CODE doSetup();
+ERROR_CODE doStats(void);
+
+ERROR_CODE newEntry(string ID, string content);
+ERROR_CODE openStore(void);
+ERROR_CODE pageValidators(string &etag, time_t &modified);
+
+string getID(void);
+string ascID(string ID);
+string readID(string str);
+
+void openEntry(string ID, string_view content = "");
+void viewEntry(string ID, string_view content, PREV_NEXT prev_next = NULL);
+ERROR_CODE viewEntries(const vector<long> &positions);
+
+void errorMessage(string handle, ERROR_CODE code);
+const char *errorString(ERROR_CODE code);
+void header(void);
+void footer(void);
+void menu(string match = "");
+
+void matchedHeader(string match);
+void addMatched(string_view content, int at, string match, string ID = "");
+void matchedFooter(int matched);
+
+void pageFooter(int limit, uint32_t newer, uint32_t older);
+int pageSize(void);
+int compressionLevel(void);
+void pageSettings(void);
+
+const string itostr(int i);
+const string ftostr(float f, int signif);
+
+string getOptions(const string directory);
+ERROR_CODE precompress(const string &directory, int level);
+
+string select(const string options, const string selected);
+
+string dirstat(const string directory);
+string filestat(const string file);
+string filenew(const string file);
+
+#endif // ACTIONS_H_
@@ -0,0 +1,177 @@
+/**
+ *  @file   config.cpp
+ *  @brief  Typed bol.cfg settings
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// the typed field of an option, NULL for options kept only as text
+static string *field(CONFIG &config, const string &option) {
+  if (option == "log")
+    return (&config.log);
+  if (option == "base")
+    return (&config.base);
+  if (option == "administrator")
+    return (&config.administrator);
+  if (option == "plugin")
+    return (&config.plugin);
+  if (option == "scheme")
+    return (&config.scheme);
+  if (option == "storage")
+    return (&config.storage);
+  if (option == "stats")
+    return (&config.stats);
+  return (NULL);
+}
+
+void configClear(CONFIG &config) {
+  config.log.clear();
+  config.base.clear();
+  config.administrator.clear();
+  config.plugin.clear();
+  config.scheme.clear();
+  config.storage.clear();
+  config.stats.clear();
+  config.page = 0;
+  config.compression = -1;
+  config.threads = -1;
+  config.settings.clear();
+  memset(&config.f_stat, 0, sizeof(struct stat));
+}
+
+void configSet(CONFIG &config, const string &option, const string &value) {
+  size_t idx = 0;
+  while (idx < config.settings.size() && config.settings[idx].first != option)
+    idx++;
+  if (idx == config.settings.size())
+    config.settings.push_back(make_pair(option, value));
+  else
+    config.settings[idx].second = value;
+
+  string *typed = field(config, option);
+  if (typed != NULL)
+    *typed = value;
+  else if (option == "page")
+    config.page = atoi(value.c_str());
+  else if (option == "compression")
+    config.compression = atoi(value.c_str());
+  else if (option == "threads")
+    config.threads = atoi(value.c_str());
+}
+
+// Lines read $option = "value"; spaces and quotes are dropped, # starts a
+// comment and a backslash continues the value on the next line. The first
+// setting of an option wins.
+ERROR_CODE configRead(const char *file, CONFIG &config) {
+  configClear(config);
+
+  ifstream ifstr(file, ios::in);
+  if (ifstr.fail())
+    return (CONFIG_READ);
+
+  char character;
+  while (ifstr.get(character).good()) {
+    if (character == '#') {
+      while (ifstr.get(character).good()) {
+        if (character == '\n')
+          break;
+      }
+    } else if (character == '$') {
+      string line;
+      while (ifstr.get(character).good()) {
+        if (character == '\n')
+          break;
+        if (character == '\\') {
+          while (ifstr.get(character).good())
+            if (character == '\n')
+              break;
+        } else if (character != ' ' && character != '\"')
+          line += character;
+      }
+
+      string::size_type equals = line.find('=');
+      string option = line.substr(0, equals);
+      bool seen = false;
+      for (size_t idx = 0; idx < config.settings.size() && !seen; idx++)
+        seen = config.settings[idx].first == option;
+      if (!option.empty() && !seen)
+        configSet(config, option,
+                  equals == string::npos ? "" : line.substr(equals + 1));
+    }
+  }
+  ifstr.close();
+
+  return (OK);
+}
+
+// written next to the file and renamed over it, so a concurrent reader
+// sees either the old or the new settings
+ERROR_CODE configWrite(const char *file, CONFIG &config) {
+  string tmp = string(file) + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out);
+  if (ofstr.fail())
+    return (CONFIG_WRITE);
+
+  ofstr << "#" << endl
+        << "# Automatic generated configuration file for BoL" << endl
+        << "#" << endl
+        << "# valid variables are $log, $base, $administrator, $schemes, "
+           "$scheme and"
+        << endl
+        << "# $storage (text, segment or sharded), $stats (request timing "
+           "file),"
+        << endl
+        << "# $compression (gzip level, 0 for none) and $threads (searching)"
+        << endl
+        << "#" << endl
+        << endl;
+
+  for (size_t idx = 0; idx < config.settings.size(); idx++)
+    ofstr << '$' << config.settings[idx].first << " = \""
+          << config.settings[idx].second << "\"" << endl;
+  ofstr.close();
+
+  if (ofstr.fail() || rename(tmp.c_str(), file) != 0) {
+    unlink(tmp.c_str());
+    return (CONFIG_WRITE);
+  }
+
+  // the settings in memory are those just written
+  stat(file, &config.f_stat);
+
+  return (OK);
+}
+
+// Persistent processes keep the parsed settings until bol.cfg changes. A
+// new version is parsed aside and only replaces the cached one once read.
+ERROR_CODE configCache(const char *file, CONFIG &config) {
+  struct stat f_stat;
+  if (stat(file, &f_stat) != 0)
+    return (CONFIG_READ);
+
+  if (!config.settings.empty() && f_stat.st_ino == config.f_stat.st_ino &&
+      f_stat.st_size == config.f_stat.st_size &&
+      f_stat.st_mtime == config.f_stat.st_mtime)
+    return (OK);
+
+  CONFIG fresh;
+  ERROR_CODE state = configRead(file, fresh);
+  if (state != OK)
+    return (state);
+
+  fresh.f_stat = f_stat;
+  swap(config, fresh);
+
+  return (OK);
+}
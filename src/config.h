@@ -0,0 +1,44 @@
+/**
+ *  @file   config.h
+ *  @brief  Typed bol.cfg settings
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <sys/stat.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+typedef struct {
+  string log;
+  string base;
+  string administrator;
+  string plugin;
+  string scheme;
+  string storage;
+  string stats;
+  int page;
+  int compression;
+  int threads;
+  vector<pair<string, string>> settings;
+  struct stat f_stat;
+} CONFIG;
+
+ERROR_CODE configRead(const char *file, CONFIG &config);
+ERROR_CODE configWrite(const char *file, CONFIG &config);
+ERROR_CODE configCache(const char *file, CONFIG &config);
+void configSet(CONFIG &config, const string &option, const string &value);
+void configClear(CONFIG &config);
+
+#endif // CONFIG_H_
@@ -0,0 +1,74 @@
+/**
+ *  @file   days.cpp
+ *  @brief  Sortable day-number keys for entry IDs
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "days.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static bool digits(const string &str, size_t at, size_t length) {
+  for (size_t i = at; i < at + length; i++)
+    if (str[i] < '0' || str[i] > '9')
+      return (false);
+  return (true);
+}
+
+static int monthDays(int year, int month) {
+  static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+    return (29);
+  return (days[month - 1]);
+}
+
+// The key counts days from 1 March of year 0, plus one so that 0 is left
+// for IDs that are not a date. Consecutive days get consecutive keys and
+// keys sort chronologically, which DDMMYYYY IDs do not.
+uint32_t dayKey(const string &ID) {
+  int year, month, day;
+  if (ID.length() == 8 && digits(ID, 0, 8)) {
+    day = atoi(ID.substr(0, 2).c_str());
+    month = atoi(ID.substr(2, 2).c_str());
+    year = atoi(ID.substr(4, 4).c_str());
+  } else if (ID.length() == 10 && digits(ID, 0, 4) && ID[4] == '-' &&
+             digits(ID, 5, 2) && ID[7] == '-' && digits(ID, 8, 2)) {
+    year = atoi(ID.substr(0, 4).c_str());
+    month = atoi(ID.substr(5, 2).c_str());
+    day = atoi(ID.substr(8, 2).c_str());
+  } else
+    return (0);
+
+  if (year < 1 || month < 1 || month > 12 || day < 1 ||
+      day > monthDays(year, month))
+    return (0);
+
+  // years start in March so the leap day falls at the end of the year
+  if (month <= 2)
+    year--;
+  uint32_t era = year / 400, yoe = year - era * 400,
+           doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1,
+           doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return (era * 146097 + doe + 1);
+}
+
+string dayID(uint32_t key) {
+  if (key == 0)
+    return ("");
+
+  uint32_t z = key - 1, era = z / 146097, doe = z - era * 146097,
+           yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365,
+           doy = doe - (365 * yoe + yoe / 4 - yoe / 100),
+           mp = (5 * doy + 2) / 153, day = doy - (153 * mp + 2) / 5 + 1,
+           month = mp < 10 ? mp + 3 : mp - 9,
+           year = yoe + era * 400 + (month <= 2);
+
+  char ID[32];
+  snprintf(ID, sizeof(ID), "%02u%02u%04u", day, month, year);
+  return (ID);
+}
@@ -0,0 +1,22 @@
+/**
+ *  @file   days.h
+ *  @brief  Sortable day-number keys for entry IDs
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef DAYS_H_
+#define DAYS_H_
+
+#include <stdint.h>
+
+#include <string>
+
+using namespace std;
+
+uint32_t dayKey(const string &ID);
+string dayID(uint32_t key);
+
+#endif // DAYS_H_
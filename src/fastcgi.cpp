@@ -0,0 +1,326 @@
+/**
+ *  @file   fastcgi.cpp
+ *  @brief  FastCGI Responder
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "fastcgi.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+#include "request.h"
+
+static bool readFully(int fd, char *buffer, size_t length) {
+  while (length > 0) {
+    ssize_t n = read(fd, buffer, length);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return (false);
+    buffer += n;
+    length -= n;
+  }
+  return (true);
+}
+
+// sends every iovec, picking up where a short write left off
+static bool writeFully(int fd, struct iovec *iov, int count) {
+  while (count > 0) {
+    ssize_t n = writev(fd, iov, count < IOV_MAX ? count : IOV_MAX);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return (false);
+    for (; count > 0 && static_cast<size_t>(n) >= iov->iov_len; iov++, count--)
+      n -= iov->iov_len;
+    if (count > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+      iov->iov_len -= n;
+    }
+  }
+  return (true);
+}
+
+static void recordHeader(char *header, unsigned char type, unsigned short id,
+                         size_t length, unsigned char padding) {
+  header[0] = FCGI_VERSION_1;
+  header[1] = static_cast<char>(type);
+  header[2] = static_cast<char>(id >> 8);
+  header[3] = static_cast<char>(id & 0xff);
+  header[4] = static_cast<char>(length >> 8);
+  header[5] = static_cast<char>(length & 0xff);
+  header[6] = static_cast<char>(padding);
+  header[7] = 0;
+}
+
+static const char zeros[8] = {0};
+
+static bool writeRecord(int fd, unsigned char type, unsigned short id,
+                        const char *content, size_t length) {
+  unsigned char padding = (8 - (length % 8)) % 8;
+  char header[8];
+  recordHeader(header, type, id, length, padding);
+
+  struct iovec iov[3] = {{header, 8},
+                         {const_cast<char *>(content), length},
+                         {const_cast<char *>(zeros), padding}};
+  return (writeFully(fd, iov, 3));
+}
+
+static bool endRequest(int fd, unsigned short id, unsigned char status) {
+  char body[8] = {0, 0, 0, 0, static_cast<char>(status), 0, 0, 0};
+  return (writeRecord(fd, FCGI_END_REQUEST, id, body, 8));
+}
+
+static size_t readLength(const string &str, size_t &pos) {
+  if (pos >= str.length())
+    return (0);
+  unsigned char b = str[pos++];
+  if (!(b & 0x80))
+    return (b);
+  if (pos + 3 > str.length()) {
+    pos = str.length();
+    return (0);
+  }
+  size_t length = ((b & 0x7f) << 24) |
+                  (static_cast<unsigned char>(str[pos]) << 16) |
+                  (static_cast<unsigned char>(str[pos + 1]) << 8) |
+                  static_cast<unsigned char>(str[pos + 2]);
+  pos += 3;
+  return (length);
+}
+
+static void writeLength(string &str, size_t length) {
+  if (length < 0x80)
+    str += static_cast<char>(length);
+  else {
+    str += static_cast<char>((length >> 24) | 0x80);
+    str += static_cast<char>((length >> 16) & 0xff);
+    str += static_cast<char>((length >> 8) & 0xff);
+    str += static_cast<char>(length & 0xff);
+  }
+}
+
+static void decodeParams(const string &str, map<string, string> &params) {
+  size_t pos = 0;
+  while (pos < str.length()) {
+    size_t nameLen = readLength(str, pos), valueLen = readLength(str, pos);
+    if (pos + nameLen + valueLen > str.length())
+      break;
+    params[str.substr(pos, nameLen)] = str.substr(pos + nameLen, valueLen);
+    pos += nameLen + valueLen;
+  }
+}
+
+static bool getValues(int fd, const string &content) {
+  map<string, string> names;
+  decodeParams(content, names);
+
+  string result;
+  for (map<string, string>::iterator it = names.begin(); it != names.end();
+       it++) {
+    string value;
+    if (it->first == "FCGI_MAX_CONNS" || it->first == "FCGI_MAX_REQS")
+      value = "1";
+    else if (it->first == "FCGI_MPXS_CONNS")
+      value = "0";
+    else
+      continue;
+    writeLength(result, it->first.length());
+    writeLength(result, value.length());
+    result += it->first + value;
+  }
+
+  return (writeRecord(fd, FCGI_GET_VALUES_RESULT, 0, result.data(),
+                      result.length()));
+}
+
+bool fcgiIsListener(int fd) {
+  struct sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+
+  return (getpeername(fd, reinterpret_cast<struct sockaddr *>(&addr), &len) !=
+              0 &&
+          errno == ENOTCONN);
+}
+
+int fcgiListen(const char *path) {
+  struct sockaddr_un addr;
+  if (strlen(path) >= sizeof(addr.sun_path))
+    return (-1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return (-1);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+
+  unlink(path);
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 64) != 0) {
+    close(fd);
+    return (-1);
+  }
+
+  return (fd);
+}
+
+int fcgiRead(int fd, FCGI_REQUEST &request) {
+  bool active = false, params = false;
+  string paramStr;
+
+  request.params.clear();
+  request.in.clear();
+
+  unsigned char header[8];
+  string content;
+  while (readFully(fd, reinterpret_cast<char *>(header), 8)) {
+    unsigned char type = header[1];
+    unsigned short id = (header[2] << 8) | header[3];
+    size_t length = (header[4] << 8) | header[5];
+
+    content.resize(length + header[6]);
+    if (!readFully(fd, &content[0], content.length()))
+      return (-1);
+    content.resize(length);
+
+    if (header[0] != FCGI_VERSION_1)
+      return (-1);
+
+    if (id == 0) {
+      if (type == FCGI_GET_VALUES) {
+        if (!getValues(fd, content))
+          return (-1);
+      } else {
+        char body[8] = {static_cast<char>(type), 0, 0, 0, 0, 0, 0, 0};
+        if (!writeRecord(fd, FCGI_UNKNOWN_TYPE, 0, body, 8))
+          return (-1);
+      }
+      continue;
+    }
+
+    if (type == FCGI_BEGIN_REQUEST) {
+      if (length < 8)
+        return (-1);
+      unsigned short role = (static_cast<unsigned char>(content[0]) << 8) |
+                            static_cast<unsigned char>(content[1]);
+      if (active) {
+        if (!endRequest(fd, id, FCGI_CANT_MPX_CONN))
+          return (-1);
+      } else if (role != FCGI_RESPONDER) {
+        if (!endRequest(fd, id, FCGI_UNKNOWN_ROLE))
+          return (-1);
+      } else {
+        active = true;
+        params = false;
+        paramStr.clear();
+        request.id = id;
+        request.keepConn = content[2] & FCGI_KEEP_CONN;
+        request.params.clear();
+        request.in.clear();
+      }
+      continue;
+    }
+
+    if (!active || id != request.id)
+      continue;
+
+    switch (type) {
+    case FCGI_ABORT_REQUEST:
+      active = false;
+      if (!endRequest(fd, id, FCGI_REQUEST_COMPLETE))
+        return (-1);
+      if (!request.keepConn)
+        return (0);
+      break;
+    case FCGI_PARAMS:
+      if (length == 0) {
+        decodeParams(paramStr, request.params);
+        params = true;
+      } else
+        paramStr += content;
+      break;
+    case FCGI_STDIN:
+      if (length == 0)
+        return (params ? 1 : -1);
+      // bodies over the limit are refused unread by the handler
+      if (request.in.length() + content.length() <= REQUEST_LIMIT)
+        request.in += content;
+      break;
+    };
+  }
+
+  return (active ? -1 : 0);
+}
+
+// STDOUT records for all of data go out in a single writev
+int fcgiWrite(int fd, const FCGI_REQUEST &request, const char *data,
+              size_t length) {
+  const size_t chunk = 0xfff8;
+  size_t records = (length + chunk - 1) / chunk;
+  vector<char> headers(records * 8);
+  vector<struct iovec> iov(records * 3);
+
+  for (size_t i = 0; i < records; i++) {
+    size_t pos = i * chunk, size = length - pos < chunk ? length - pos : chunk;
+    unsigned char padding = (8 - (size % 8)) % 8;
+    recordHeader(&headers[i * 8], FCGI_STDOUT, request.id, size, padding);
+    iov[i * 3].iov_base = &headers[i * 8];
+    iov[i * 3].iov_len = 8;
+    iov[i * 3 + 1].iov_base = const_cast<char *>(data + pos);
+    iov[i * 3 + 1].iov_len = size;
+    iov[i * 3 + 2].iov_base = const_cast<char *>(zeros);
+    iov[i * 3 + 2].iov_len = padding;
+  }
+
+  return (writeFully(fd, iov.data(), iov.size()) ? 0 : -1);
+}
+
+// closes the STDOUT stream and completes the request
+int fcgiEnd(int fd, const FCGI_REQUEST &request) {
+  char stdoutHeader[8], endHeader[8];
+  char body[8] = {0, 0, 0, 0, FCGI_REQUEST_COMPLETE, 0, 0, 0};
+  recordHeader(stdoutHeader, FCGI_STDOUT, request.id, 0, 0);
+  recordHeader(endHeader, FCGI_END_REQUEST, request.id, 8, 0);
+
+  struct iovec iov[3] = {{stdoutHeader, 8}, {endHeader, 8}, {body, 8}};
+  return (writeFully(fd, iov, 3) ? 0 : -1);
+}
+
+int fcgiServe(int listener, FCGI_HANDLER handler) {
+  signal(SIGPIPE, SIG_IGN);
+
+  FCGI_REQUEST request;
+  while (true) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      return (-1);
+    }
+
+    while (fcgiRead(fd, request) == 1) {
+      if (handler(fd, request) != 0 || fcgiEnd(fd, request) != 0 ||
+          !request.keepConn)
+        break;
+    }
+
+    close(fd);
+  }
+
+  return (0);
+}
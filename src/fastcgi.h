@@ -0,0 +1,58 @@
+/**
+ *  @file   fastcgi.h
+ *  @brief  FastCGI Responder
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef FASTCGI_H_
+#define FASTCGI_H_
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+#define FCGI_VERSION_1 1
+
+#define FCGI_BEGIN_REQUEST 1
+#define FCGI_ABORT_REQUEST 2
+#define FCGI_END_REQUEST 3
+#define FCGI_PARAMS 4
+#define FCGI_STDIN 5
+#define FCGI_STDOUT 6
+#define FCGI_STDERR 7
+#define FCGI_DATA 8
+#define FCGI_GET_VALUES 9
+#define FCGI_GET_VALUES_RESULT 10
+#define FCGI_UNKNOWN_TYPE 11
+
+#define FCGI_RESPONDER 1
+#define FCGI_KEEP_CONN 1
+
+#define FCGI_REQUEST_COMPLETE 0
+#define FCGI_CANT_MPX_CONN 1
+#define FCGI_OVERLOADED 2
+#define FCGI_UNKNOWN_ROLE 3
+
+typedef struct {
+  unsigned short id;
+  bool keepConn;
+  map<string, string> params;
+  string in;
+} FCGI_REQUEST;
+
+typedef int (*FCGI_HANDLER)(int fd, const FCGI_REQUEST &request);
+
+bool fcgiIsListener(int fd);
+int fcgiListen(const char *path);
+int fcgiServe(int listener, FCGI_HANDLER handler);
+
+int fcgiRead(int fd, FCGI_REQUEST &request);
+int fcgiWrite(int fd, const FCGI_REQUEST &request, const char *data,
+              size_t length);
+int fcgiEnd(int fd, const FCGI_REQUEST &request);
+
+#endif // FASTCGI_H_
@@ -0,0 +1,83 @@
+/**
+ *  @file   fragments.cpp
+ *  @brief  Cache of rendered entries and pages
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "fragments.h"
+
+#include <list>
+#include <map>
+
+#include "stats.h"
+
+// Fragments are entries as rendered, filed under their ID, and whole
+// compressed pages as sent, filed under "". Forgetting an entry or the
+// pages is one range of the map. The list holds them most recently used first.
+typedef list<pair<string, string>> FRAGMENTS_ORDER;
+typedef map<string, FRAGMENTS_ORDER::iterator> FRAGMENTS_MAP;
+
+static FRAGMENTS_ORDER order;
+static FRAGMENTS_MAP fragments;
+static size_t cached = 0;
+
+static string filed(const string &ID, const string &key) {
+  return (ID + '\0' + key);
+}
+
+static void drop(FRAGMENTS_MAP::iterator it) {
+  cached -= it->first.length() + it->second->second.length();
+  order.erase(it->second);
+  fragments.erase(it);
+}
+
+// the markup rendered for key, valid until the next fragmentsAdd
+const string *fragmentsFind(const string &ID, const string &key) {
+  FRAGMENTS_MAP::iterator it = fragments.find(filed(ID, key));
+  if (it == fragments.end()) {
+    statsCount(STATS_MISSES, 1);
+    return (NULL);
+  }
+
+  statsCount(STATS_HITS, 1);
+  order.splice(order.begin(), order, it->second);
+
+  return (&it->second->second);
+}
+
+// whether a fragment is kept, without counting the lookup or moving it up
+bool fragmentsHas(const string &ID, const string &key) {
+  return (fragments.find(filed(ID, key)) != fragments.end());
+}
+
+void fragmentsAdd(const string &ID, const string &key, const string &html) {
+  string name = filed(ID, key);
+  FRAGMENTS_MAP::iterator it = fragments.find(name);
+  if (it != fragments.end())
+    drop(it);
+
+  if (name.length() + html.length() > FRAGMENTS_LIMIT)
+    return;
+
+  order.push_front(make_pair(name, html));
+  fragments[name] = order.begin();
+  cached += name.length() + html.length();
+
+  while (cached > FRAGMENTS_LIMIT)
+    drop(fragments.find(order.back().first));
+}
+
+// every fragment of the entry, for when it or its neighbours change, or
+// with ID "" every page
+void fragmentsForget(const string &ID) {
+  string first = ID + '\0';
+  FRAGMENTS_MAP::iterator it = fragments.lower_bound(first);
+  while (it != fragments.end() &&
+         it->first.compare(0, first.length(), first) == 0)
+    drop(it++);
+}
+
+size_t fragmentsSize(void) { return (cached); }
@@ -0,0 +1,29 @@
+/**
+ *  @file   fragments.h
+ *  @brief  Cache of rendered entries and pages
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef FRAGMENTS_H_
+#define FRAGMENTS_H_
+
+#include <stddef.h>
+
+#include <string>
+
+using namespace std;
+
+// bytes of keys and markup kept before the least recently used go
+#define FRAGMENTS_LIMIT 16777216
+
+const string *fragmentsFind(const string &ID, const string &key);
+bool fragmentsHas(const string &ID, const string &key);
+void fragmentsAdd(const string &ID, const string &key, const string &html);
+void fragmentsForget(const string &ID);
+
+size_t fragmentsSize(void);
+
+#endif // FRAGMENTS_H_
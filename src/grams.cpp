@@ -0,0 +1,417 @@
+/**
+ *  @file   grams.cpp
+ *  @brief  Trigram index for substring search
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "grams.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "days.h"
+
+static const char gramsMagic[8] = {'B', 'o', 'L', 'g', 'r', 'm', '2', '\0'};
+
+typedef struct {
+  uint32_t count;
+  string data;
+} GRAMS_POSTINGS;
+
+static void putVarint(string &out, uint32_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out += static_cast<char>(value);
+}
+
+static bool getVarint(const char *&at, const char *end, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; at < end && shift < 35; shift += 7) {
+    unsigned char c = *at++;
+    value |= static_cast<uint32_t>(c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return (true);
+  }
+  return (false);
+}
+
+// folds case the same way the search kernel does
+static inline uint32_t fold(unsigned char c) {
+  return (c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+}
+
+static void trigrams(string_view text, vector<uint32_t> &grams) {
+  grams.clear();
+  if (text.length() < 3)
+    return;
+
+  uint32_t gram = fold(text[0]) << 8 | fold(text[1]);
+  for (size_t i = 2; i < text.length(); i++) {
+    gram = (gram << 8 | fold(text[i])) & 0xffffff;
+    grams.push_back(gram);
+  }
+
+  sort(grams.begin(), grams.end());
+  grams.erase(unique(grams.begin(), grams.end()), grams.end());
+}
+
+static void encodeList(const vector<uint32_t> &keys, GRAMS_POSTINGS &list) {
+  list.count = keys.size();
+  list.data.clear();
+
+  uint32_t previous = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    putVarint(list.data, keys[i] - previous);
+    previous = keys[i];
+  }
+}
+
+static bool decodeList(const char *at, const char *end, uint32_t count,
+                       vector<uint32_t> &keys) {
+  uint32_t key = 0, delta;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!getVarint(at, end, delta))
+      return (false);
+    keys.push_back(key += delta);
+  }
+
+  return (true);
+}
+
+static size_t layoutLength(const GRAMS_HEADER *header) {
+  return (sizeof(GRAMS_HEADER) + header->grams * sizeof(GRAMS_LIST) +
+          header->blob);
+}
+
+static void layout(GRAMS_INDEX &index, const char *data) {
+  index.header = reinterpret_cast<const GRAMS_HEADER *>(data);
+  index.lists =
+      reinterpret_cast<const GRAMS_LIST *>(data + sizeof(GRAMS_HEADER));
+  index.blob = data + sizeof(GRAMS_HEADER) +
+               index.header->grams * sizeof(GRAMS_LIST);
+}
+
+static ERROR_CODE mapGrams(GRAMS_INDEX &index) {
+  int fd = open(index.path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return (IO_READ);
+
+  struct stat g_stat;
+  if (fstat(fd, &g_stat) != 0 ||
+      static_cast<size_t>(g_stat.st_size) < sizeof(GRAMS_HEADER)) {
+    close(fd);
+    return (STRUCTURE);
+  }
+
+  void *map = mmap(NULL, g_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return (IO_READ);
+
+  const GRAMS_HEADER *header = static_cast<const GRAMS_HEADER *>(map);
+  if (memcmp(header->magic, gramsMagic, 8) != 0 ||
+      layoutLength(header) != static_cast<size_t>(g_stat.st_size)) {
+    munmap(map, g_stat.st_size);
+    return (STRUCTURE);
+  }
+
+  index.map = map;
+  index.mapLength = g_stat.st_size;
+  layout(index, static_cast<const char *>(map));
+
+  return (OK);
+}
+
+static void stamp(GRAMS_HEADER &header, const struct stat &f_stat) {
+  header.size = f_stat.st_size;
+  header.mtime = f_stat.st_mtime;
+  header.inode = f_stat.st_ino;
+}
+
+// adds length bytes at data to the pieces, as part of the last one if it
+// ends right there
+static void addPiece(vector<string_view> &pieces, const char *data,
+                     size_t length) {
+  if (!pieces.empty() && pieces.back().data() + pieces.back().length() == data)
+    pieces.back() = string_view(pieces.back().data(),
+                                pieces.back().length() + length);
+  else
+    pieces.push_back(string_view(data, length));
+}
+
+// Writes the index out of pieces, which may point into its current mapping,
+// and maps the new file in its place.
+static ERROR_CODE writeGrams(GRAMS_INDEX &index,
+                             const vector<string_view> &pieces) {
+  string tmp = index.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  for (size_t i = 0; !ofstr.fail() && i < pieces.size(); i++)
+    ofstr.write(pieces[i].data(), pieces[i].length());
+  ofstr.close();
+
+  GRAMS_INDEX written = {};
+  written.path = index.path;
+  if (!ofstr.fail() && rename(tmp.c_str(), index.path.c_str()) == 0 &&
+      mapGrams(written) == OK) {
+    gramsClose(index);
+    index = written;
+    return (OK);
+  }
+  unlink(tmp.c_str());
+
+  // the sidecar could not be written; keep searching from memory
+  string data;
+  for (size_t i = 0; i < pieces.size(); i++)
+    data += pieces[i];
+  gramsClose(index);
+  index.map = new char[data.length()];
+  index.mapLength = 0;
+  memcpy(index.map, data.data(), data.length());
+  layout(index, static_cast<const char *>(index.map));
+
+  return (OK);
+}
+
+static ERROR_CODE writeLists(GRAMS_INDEX &index, const struct stat &f_stat,
+                             uint32_t unkeyed,
+                             const map<uint32_t, GRAMS_POSTINGS> &lists) {
+  GRAMS_HEADER header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, gramsMagic, 8);
+  stamp(header, f_stat);
+  header.grams = lists.size();
+  header.unkeyed = unkeyed;
+
+  string table, blob;
+  for (map<uint32_t, GRAMS_POSTINGS>::const_iterator it = lists.begin();
+       it != lists.end(); it++) {
+    GRAMS_LIST list = {it->first, it->second.count, blob.length(),
+                       it->second.data.length()};
+    table.append(reinterpret_cast<const char *>(&list), sizeof(list));
+    blob += it->second.data;
+  }
+  header.blob = blob.length();
+
+  vector<string_view> pieces;
+  pieces.push_back(
+      string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+  pieces.push_back(table);
+  pieces.push_back(blob);
+
+  return (writeGrams(index, pieces));
+}
+
+static const GRAMS_LIST *findGram(const GRAMS_INDEX &index, uint32_t gram) {
+  long low = 0, high = index.header->grams;
+  while (low < high) {
+    long mid = (low + high) / 2;
+    if (index.lists[mid].gram < gram)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low < static_cast<long>(index.header->grams) &&
+      index.lists[low].gram == gram)
+    return (&index.lists[low]);
+
+  return (NULL);
+}
+
+ERROR_CODE gramsLoad(const string &log, GRAMS_INDEX &index) {
+  gramsClose(index);
+  index.path = log + ".grams";
+
+  return (mapGrams(index));
+}
+
+bool gramsCurrent(const GRAMS_INDEX &index, const struct stat &f_stat) {
+  return (index.map != NULL &&
+          index.header->size == static_cast<uint64_t>(f_stat.st_size) &&
+          index.header->mtime == static_cast<int64_t>(f_stat.st_mtime) &&
+          index.header->inode == static_cast<uint64_t>(f_stat.st_ino));
+}
+
+ERROR_CODE gramsBuild(GRAMS_INDEX &index, const string &log,
+                      const struct stat &f_stat,
+                      const vector<GRAMS_ENTRY> &entries) {
+  // postings are delta coded, so add the entries in key order
+  map<uint32_t, string_view> docs;
+  uint32_t unkeyed = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    uint32_t key = dayKey(entries[i].first);
+    if (key != 0 && docs.find(key) == docs.end())
+      docs[key] = entries[i].second;
+    else
+      unkeyed++;
+  }
+
+  map<uint32_t, vector<uint32_t>> keys;
+  vector<uint32_t> grams;
+  for (map<uint32_t, string_view>::iterator doc = docs.begin();
+       doc != docs.end(); doc++) {
+    trigrams(doc->second, grams);
+    for (size_t i = 0; i < grams.size(); i++)
+      keys[grams[i]].push_back(doc->first);
+  }
+
+  map<uint32_t, GRAMS_POSTINGS> lists;
+  for (map<uint32_t, vector<uint32_t>>::iterator it = keys.begin();
+       it != keys.end(); it++)
+    encodeList(it->second, lists[it->first]);
+
+  gramsClose(index);
+  index.path = log + ".grams";
+
+  return (writeLists(index, f_stat, unkeyed, lists));
+}
+
+ERROR_CODE gramsUpdate(GRAMS_INDEX &index, const struct stat &f_stat,
+                       const string &ID, string_view previous,
+                       string_view content) {
+  uint32_t key = dayKey(ID);
+  if (index.map == NULL || key == 0)
+    return (STRUCTURE);
+
+  // only the lists of trigrams that were or are in the entry change
+  vector<uint32_t> before, after, touched;
+  trigrams(previous, before);
+  trigrams(content, after);
+  set_union(before.begin(), before.end(), after.begin(), after.end(),
+            back_inserter(touched));
+
+  map<uint32_t, GRAMS_POSTINGS> lists;
+  for (size_t i = 0; i < touched.size(); i++) {
+    vector<uint32_t> keys;
+    const GRAMS_LIST *list = findGram(index, touched[i]);
+    if (list != NULL &&
+        !decodeList(index.blob + list->offset,
+                    index.blob + list->offset + list->length, list->count,
+                    keys))
+      return (STRUCTURE);
+
+    vector<uint32_t>::iterator at = lower_bound(keys.begin(), keys.end(), key);
+    if (at != keys.end() && *at == key)
+      at = keys.erase(at);
+    if (binary_search(after.begin(), after.end(), touched[i]))
+      keys.insert(at, key);
+
+    encodeList(keys, lists[touched[i]]);
+  }
+
+  // The table is written anew, the blob is copied over in runs of unchanged
+  // lists, each of which lies right after the one before it, with the
+  // changed lists in between.
+  GRAMS_HEADER header = *index.header;
+  stamp(header, f_stat);
+  vector<string_view> blob;
+  string table;
+  uint64_t offset = 0;
+  map<uint32_t, GRAMS_POSTINGS>::iterator changed = lists.begin();
+  for (uint32_t i = 0; i < index.header->grams || changed != lists.end();) {
+    if (changed == lists.end() ||
+        (i < index.header->grams && index.lists[i].gram < changed->first)) {
+      GRAMS_LIST list = index.lists[i++];
+      addPiece(blob, index.blob + list.offset, list.length);
+      list.offset = offset;
+      offset += list.length;
+      table.append(reinterpret_cast<const char *>(&list), sizeof(list));
+      continue;
+    }
+
+    if (i < index.header->grams && index.lists[i].gram == changed->first)
+      i++;
+    const GRAMS_POSTINGS &postings = changed->second;
+    if (postings.count > 0) {
+      GRAMS_LIST list = {changed->first, postings.count, offset,
+                         postings.data.length()};
+      addPiece(blob, postings.data.data(), postings.data.length());
+      offset += list.length;
+      table.append(reinterpret_cast<const char *>(&list), sizeof(list));
+    }
+    changed++;
+  }
+  header.grams = table.length() / sizeof(GRAMS_LIST);
+  header.blob = offset;
+
+  vector<string_view> pieces;
+  pieces.push_back(
+      string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+  pieces.push_back(table);
+  pieces.insert(pieces.end(), blob.begin(), blob.end());
+
+  return (writeGrams(index, pieces));
+}
+
+void gramsClose(GRAMS_INDEX &index) {
+  if (index.map != NULL) {
+    if (index.mapLength)
+      munmap(index.map, index.mapLength);
+    else
+      delete[] static_cast<char *>(index.map);
+  }
+  index.map = NULL;
+  index.mapLength = 0;
+  index.header = NULL;
+  index.lists = NULL;
+  index.blob = NULL;
+}
+
+bool gramsCandidates(const GRAMS_INDEX &index, const string &match,
+                     vector<string> &IDs) {
+  vector<uint32_t> grams;
+  trigrams(match, grams);
+
+  // entries without a unique date ID are not in the index, search them all
+  if (index.map == NULL || index.header->unkeyed != 0 || grams.empty())
+    return (false);
+
+  // intersect the posting lists, shortest first
+  vector<const GRAMS_LIST *> lists;
+  for (size_t i = 0; i < grams.size(); i++) {
+    const GRAMS_LIST *list = findGram(index, grams[i]);
+    if (list == NULL)
+      return (true);
+    lists.push_back(list);
+  }
+  sort(lists.begin(), lists.end(),
+       [](const GRAMS_LIST *x, const GRAMS_LIST *y) {
+         return (x->count < y->count);
+       });
+
+  vector<uint32_t> keys, next, common;
+  for (size_t i = 0; i < lists.size(); i++) {
+    const char *at = index.blob + lists[i]->offset;
+    next.clear();
+    if (!decodeList(at, at + lists[i]->length, lists[i]->count, next))
+      return (false);
+
+    if (i == 0)
+      keys.swap(next);
+    else {
+      common.clear();
+      set_intersection(keys.begin(), keys.end(), next.begin(), next.end(),
+                       back_inserter(common));
+      keys.swap(common);
+    }
+    if (keys.empty())
+      break;
+  }
+
+  for (size_t i = 0; i < keys.size(); i++)
+    IDs.push_back(dayID(keys[i]));
+
+  return (true);
+}
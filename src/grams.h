@@ -0,0 +1,66 @@
+/**
+ *  @file   grams.h
+ *  @brief  Trigram index for substring search
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef GRAMS_H_
+#define GRAMS_H_
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+typedef struct {
+  char magic[8];
+  uint64_t size;
+  int64_t mtime;
+  uint64_t inode;
+  uint32_t grams;
+  uint32_t unkeyed;
+  uint64_t blob;
+} GRAMS_HEADER;
+
+typedef struct {
+  uint32_t gram;
+  uint32_t count;
+  uint64_t offset;
+  uint64_t length;
+} GRAMS_LIST;
+
+typedef struct {
+  string path;
+  void *map;
+  size_t mapLength;
+  const GRAMS_HEADER *header;
+  const GRAMS_LIST *lists;
+  const char *blob;
+} GRAMS_INDEX;
+
+typedef pair<string, string_view> GRAMS_ENTRY;
+
+ERROR_CODE gramsLoad(const string &log, GRAMS_INDEX &index);
+bool gramsCurrent(const GRAMS_INDEX &index, const struct stat &f_stat);
+ERROR_CODE gramsBuild(GRAMS_INDEX &index, const string &log,
+                      const struct stat &f_stat,
+                      const vector<GRAMS_ENTRY> &entries);
+ERROR_CODE gramsUpdate(GRAMS_INDEX &index, const struct stat &f_stat,
+                       const string &ID, string_view previous,
+                       string_view content);
+void gramsClose(GRAMS_INDEX &index);
+
+bool gramsCandidates(const GRAMS_INDEX &index, const string &match,
+                     vector<string> &IDs);
+
+#endif // GRAMS_H_
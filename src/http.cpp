@@ -0,0 +1,653 @@
+/**
+ *  @file   http.cpp
+ *  @brief  HTTP/1.1 server
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "http.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "request.h"
+#include "response.h"
+
+// A connection reads requests into in and queues the responses in out,
+// a static file goes out after them with sendfile. Pipelined requests
+// wait while a file is being sent so the responses stay in order.
+typedef struct {
+  string in;
+  string out;
+  size_t sent;
+  int file;
+  off_t offset;
+  size_t remaining;
+  bool closing;
+  bool eof;
+  bool writing;
+  time_t active;
+  string peer;
+} HTTP_CONNECTION;
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int) { stopping = 1; }
+
+// "port", "host:port" or "[v6 address]:port"
+int httpListen(const char *address) {
+  string host, port = address;
+  size_t colon = port.rfind(':');
+  if (colon != string::npos) {
+    host = port.substr(0, colon);
+    port = port.substr(colon + 1);
+  }
+  if (host.length() > 1 && host[0] == '[' && host[host.length() - 1] == ']')
+    host = host.substr(1, host.length() - 2);
+
+  struct addrinfo hints, *addresses;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  if (getaddrinfo(host.empty() ? NULL : host.c_str(), port.c_str(), &hints,
+                  &addresses) != 0)
+    return (-1);
+
+  int fd = -1;
+  for (struct addrinfo *at = addresses; at != NULL && fd < 0;
+       at = at->ai_next) {
+    fd = socket(at->ai_family, at->ai_socktype | SOCK_CLOEXEC,
+                at->ai_protocol);
+    if (fd < 0)
+      continue;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, at->ai_addr, at->ai_addrlen) != 0 || listen(fd, 128) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+
+  return (fd);
+}
+
+static const char *param(const HTTP_REQUEST &request, const char *name) {
+  map<string, string>::const_iterator it = request.params.find(name);
+  if (it == request.params.end())
+    return (NULL);
+
+  return (it->second.c_str());
+}
+
+static bool listed(const string &value, const char *token) {
+  size_t begin = 0;
+  while (begin < value.length()) {
+    size_t end = value.find(',', begin);
+    if (end == string::npos)
+      end = value.length();
+
+    size_t first = value.find_first_not_of(" \t", begin);
+    size_t last = value.find_last_not_of(" \t", end - 1);
+    if (first < end && last - first + 1 == strlen(token) &&
+        strncasecmp(value.data() + first, token, strlen(token)) == 0)
+      return (true);
+    begin = end + 1;
+  }
+
+  return (false);
+}
+
+// Takes the first request off in. Returns 1 for a complete request, 0
+// while more has to be read and otherwise the status to refuse it with.
+static int parseRequest(string &in, HTTP_REQUEST &request) {
+  size_t end = in.find("\r\n\r\n"), skip = 4, bare = in.find("\n\n");
+  if (bare < end) {
+    end = bare;
+    skip = 2;
+  }
+  if (end == string::npos)
+    return (in.length() > HTTP_HEADER_LIMIT ? 431 : 0);
+  if (end > HTTP_HEADER_LIMIT)
+    return (431);
+
+  request.params.clear();
+  request.in.clear();
+
+  string head = in.substr(0, end);
+  size_t eol = head.find('\n');
+  string line = head.substr(0, eol);
+  if (!line.empty() && line[line.length() - 1] == '\r')
+    line.erase(line.length() - 1);
+
+  size_t first = line.find(' '), last = line.rfind(' ');
+  if (first == string::npos || first == last)
+    return (400);
+  string method = line.substr(0, first),
+         target = line.substr(first + 1, last - first - 1),
+         version = line.substr(last + 1);
+  if (version.compare(0, 7, "HTTP/1.") != 0)
+    return (505);
+  if (target.empty() || target[0] != '/')
+    return (400);
+
+  // header names become CGI variables, Content-Type and Content-Length
+  // without the HTTP_ in front
+  while (eol != string::npos) {
+    size_t begin = eol + 1;
+    eol = head.find('\n', begin);
+    line = head.substr(begin, eol == string::npos ? string::npos : eol - begin);
+    if (!line.empty() && line[line.length() - 1] == '\r')
+      line.erase(line.length() - 1);
+
+    size_t colon = line.find(':');
+    if (colon == string::npos || colon == 0)
+      return (400);
+
+    string name = line.substr(0, colon), value;
+    size_t from = line.find_first_not_of(" \t", colon + 1);
+    if (from != string::npos)
+      value = line.substr(from, line.find_last_not_of(" \t") - from + 1);
+
+    for (size_t i = 0; i < name.length(); i++)
+      name[i] = name[i] == '-' ? '_' : toupper(name[i]);
+    if (name != "CONTENT_TYPE" && name != "CONTENT_LENGTH")
+      name = "HTTP_" + name;
+
+    string &set = request.params[name];
+    set = set.empty() ? value : set + ", " + value;
+  }
+
+  if (param(request, "HTTP_TRANSFER_ENCODING") != NULL)
+    return (501);
+
+  const char *connection = param(request, "HTTP_CONNECTION");
+  request.keepAlive =
+      version == "HTTP/1.0"
+          ? connection != NULL && listed(connection, "keep-alive")
+          : connection == NULL || !listed(connection, "close");
+
+  size_t length = 0;
+  const char *announced = param(request, "CONTENT_LENGTH");
+  if (announced != NULL) {
+    char *digits;
+    length = strtoul(announced, &digits, 10);
+    if (*announced == '\0' || *digits != '\0' || *announced == '-')
+      return (400);
+  }
+
+  // a body over the limit is refused unread, which ends the connection
+  size_t body = end + skip;
+  if (length > REQUEST_LIMIT) {
+    request.keepAlive = false;
+    in.clear();
+  } else {
+    if (in.length() < body + length)
+      return (0);
+    request.in = in.substr(body, length);
+    in.erase(0, body + length);
+  }
+
+  size_t question = target.find('?');
+  request.params["REQUEST_METHOD"] = method;
+  request.params["SERVER_PROTOCOL"] = version;
+  request.params["SCRIPT_NAME"] = target.substr(0, question);
+  request.params["QUERY_STRING"] =
+      question == string::npos ? "" : target.substr(question + 1);
+
+  return (1);
+}
+
+static const char *reason(int status) {
+  switch (status) {
+  case 200:
+    return ("OK");
+  case 304:
+    return ("Not Modified");
+  case 400:
+    return ("Bad Request");
+  case 404:
+    return ("Not Found");
+  case 405:
+    return ("Method Not Allowed");
+  case 431:
+    return ("Request Header Fields Too Large");
+  case 501:
+    return ("Not Implemented");
+  case 505:
+    return ("HTTP Version Not Supported");
+  }
+  return ("Internal Server Error");
+}
+
+static string statusLine(const string &status, const HTTP_CONNECTION &c) {
+  return ("HTTP/1.1 " + status + "\r\nDate: " + responseDate(time(NULL)) +
+          "\r\nConnection: " + (c.closing ? "close" : "keep-alive") + "\r\n");
+}
+
+static void error(HTTP_CONNECTION &c, int status) {
+  string text = to_string(status) + " " + reason(status),
+         body = "<html><body><h1>" + text + "</h1></body></html>\n";
+  c.out += statusLine(text, c) +
+           "Content-Type: text/html; charset=iso-8859-1\r\nContent-Length: " +
+           to_string(body.length()) + "\r\n\r\n" + body;
+}
+
+static const char *contentType(const string &path) {
+  const char *types[][2] = {
+      {".css", "text/css"},       {".js", "application/javascript"},
+      {".png", "image/png"},      {".gif", "image/gif"},
+      {".jpg", "image/jpeg"},     {".jpeg", "image/jpeg"},
+      {".ico", "image/x-icon"},   {".svg", "image/svg+xml"},
+      {".html", "text/html"},     {".txt", "text/plain"}};
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    size_t length = strlen(types[i][0]);
+    if (path.length() > length &&
+        strcasecmp(path.c_str() + path.length() - length, types[i][0]) == 0)
+      return (types[i][1]);
+  }
+
+  return ("application/octet-stream");
+}
+
+// A file below the working directory, or its .gz copy when the client
+// takes gzip and the copy is up to date.
+static void staticFile(HTTP_CONNECTION &c, const HTTP_REQUEST &request,
+                       const string &path, bool head) {
+  string file = path.substr(1);
+  struct stat f_stat, gz_stat;
+  if (path.find("..") != string::npos || path.find("//") != string::npos ||
+      stat(file.c_str(), &f_stat) != 0 || !S_ISREG(f_stat.st_mode)) {
+    error(c, 404);
+    return;
+  }
+
+  bool compressed = stat((file + ".gz").c_str(), &gz_stat) == 0 &&
+                    gz_stat.st_mtime >= f_stat.st_mtime,
+       gzip = compressed &&
+              requestAccepts(param(request, "HTTP_ACCEPT_ENCODING"), "gzip");
+  if (gzip)
+    f_stat = gz_stat;
+
+  char tag[48];
+  snprintf(tag, sizeof(tag), "\"%llx-%llx%s\"",
+           static_cast<unsigned long long>(f_stat.st_size),
+           static_cast<unsigned long long>(f_stat.st_mtime),
+           gzip ? "-gzip" : "");
+
+  string headers = string("Content-Type: ") + contentType(file) +
+                   "\r\nLast-Modified: " + responseDate(f_stat.st_mtime) +
+                   "\r\nETag: " + tag + "\r\n";
+  if (compressed)
+    headers += "Vary: Accept-Encoding\r\n";
+
+  if (requestUnchanged(param(request, "HTTP_IF_NONE_MATCH"),
+                       param(request, "HTTP_IF_MODIFIED_SINCE"), tag,
+                       f_stat.st_mtime)) {
+    c.out += statusLine("304 Not Modified", c) + headers + "\r\n";
+    return;
+  }
+
+  int fd = open((gzip ? file + ".gz" : file).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error(c, 404);
+    return;
+  }
+
+  if (gzip)
+    headers += "Content-Encoding: gzip\r\n";
+  c.out += statusLine("200 OK", c) + headers +
+           "Content-Length: " + to_string(f_stat.st_size) + "\r\n\r\n";
+
+  if (head || f_stat.st_size == 0)
+    close(fd);
+  else {
+    c.file = fd;
+    c.offset = 0;
+    c.remaining = f_stat.st_size;
+  }
+}
+
+// the CGI output of the handler as an HTTP response
+static void dynamic(HTTP_CONNECTION &c, const HTTP_REQUEST &request,
+                    HTTP_HANDLER handler, bool head) {
+  string output;
+  handler(request, output);
+
+  size_t end = output.find("\n\n");
+  if (end == string::npos) {
+    error(c, 500);
+    return;
+  }
+
+  string status = "200 OK", headers;
+  size_t begin = 0;
+  while (begin < end) {
+    size_t eol = min(output.find('\n', begin), end);
+    string line = output.substr(begin, eol - begin);
+    if (line.compare(0, 7, "Status:") == 0)
+      status = line.substr(line.find_first_not_of(' ', 7));
+    else
+      headers += line + "\r\n";
+    begin = eol + 1;
+  }
+
+  bool empty = status.compare(0, 3, "304") == 0;
+  c.out += statusLine(status, c) + headers;
+  if (!empty)
+    c.out += "Content-Length: " + to_string(output.length() - end - 2) +
+             "\r\n";
+  c.out += "\r\n";
+  if (!head && !empty)
+    c.out.append(output, end + 2, string::npos);
+}
+
+static void handle(HTTP_CONNECTION &c, HTTP_REQUEST &request,
+                   HTTP_HANDLER handler) {
+  request.params["REMOTE_ADDR"] = c.peer;
+  if (!request.keepAlive)
+    c.closing = true;
+
+  const string &path = request.params["SCRIPT_NAME"],
+               &method = request.params["REQUEST_METHOD"];
+  bool head = method == "HEAD";
+
+  if (path == "/bol.ico" || path.compare(0, 8, "/images/") == 0 ||
+      path.compare(0, 8, "/themes/") == 0) {
+    if (method == "GET" || head)
+      staticFile(c, request, path, head);
+    else
+      error(c, 405);
+  } else if (path == "/" || path == "/index.cgi")
+    dynamic(c, request, handler, head);
+  else
+    error(c, 404);
+}
+
+// sends what it can without blocking, false once the connection failed
+static bool flush(int fd, HTTP_CONNECTION &c) {
+  while (c.sent < c.out.length()) {
+    ssize_t n =
+        send(fd, c.out.data() + c.sent, c.out.length() - c.sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    c.sent += n;
+    c.active = time(NULL);
+  }
+  c.out.clear();
+  c.sent = 0;
+
+  while (c.remaining > 0) {
+    ssize_t n = sendfile(fd, c.file, &c.offset, c.remaining);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    // the file shrank under us
+    if (n == 0)
+      return (false);
+    c.remaining -= n;
+    c.active = time(NULL);
+  }
+  if (c.file >= 0) {
+    close(c.file);
+    c.file = -1;
+  }
+
+  return (true);
+}
+
+static bool receive(int fd, HTTP_CONNECTION &c) {
+  char buffer[16384];
+  while (c.in.length() <= HTTP_HEADER_LIMIT + REQUEST_LIMIT) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    if (n == 0) {
+      c.eof = true;
+      return (true);
+    }
+    c.in.append(buffer, n);
+    c.active = time(NULL);
+  }
+
+  return (true);
+}
+
+// Answers the requests read so far and sends what it can. Returns false
+// once the connection is to be closed.
+static bool progress(int fd, HTTP_CONNECTION &c, HTTP_HANDLER handler) {
+  HTTP_REQUEST request;
+  while (true) {
+    bool waiting = false;
+    while (!c.closing && c.file < 0) {
+      int parsed = parseRequest(c.in, request);
+      if (parsed == 0) {
+        waiting = true;
+        break;
+      }
+      if (parsed == 1)
+        handle(c, request, handler);
+      else {
+        c.closing = true;
+        error(c, parsed);
+      }
+    }
+
+    if (!flush(fd, c))
+      return (false);
+    if (!c.out.empty() || c.file >= 0)
+      return (true);
+    if (c.closing)
+      return (false);
+    if (waiting)
+      return (!c.eof);
+  }
+}
+
+// while output is pending the connection waits to be writable and reads
+// nothing more
+static void watch(int epoll, int fd, HTTP_CONNECTION &c) {
+  bool writing = !c.out.empty() || c.file >= 0;
+  if (writing == c.writing)
+    return;
+
+  struct epoll_event event;
+  event.events = (writing ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP;
+  event.data.fd = fd;
+  epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &event);
+  c.writing = writing;
+}
+
+static void release(int epoll, map<int, HTTP_CONNECTION> &connections,
+                    map<int, HTTP_CONNECTION>::iterator it) {
+  epoll_ctl(epoll, EPOLL_CTL_DEL, it->first, NULL);
+  if (it->second.file >= 0)
+    close(it->second.file);
+  close(it->first);
+  connections.erase(it);
+}
+
+static void accepted(int epoll, int listener,
+                     map<int, HTTP_CONNECTION> &connections) {
+  while (true) {
+    struct sockaddr_storage addr;
+    socklen_t length = sizeof(addr);
+    int fd = accept4(listener, reinterpret_cast<struct sockaddr *>(&addr),
+                     &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      return;
+    }
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    char peer[INET6_ADDRSTRLEN] = "";
+    if (addr.ss_family == AF_INET)
+      inet_ntop(AF_INET, &reinterpret_cast<struct sockaddr_in *>(&addr)->sin_addr,
+                peer, sizeof(peer));
+    else if (addr.ss_family == AF_INET6)
+      inet_ntop(AF_INET6,
+                &reinterpret_cast<struct sockaddr_in6 *>(&addr)->sin6_addr,
+                peer, sizeof(peer));
+
+    HTTP_CONNECTION &c = connections[fd];
+    c.sent = 0;
+    c.file = -1;
+    c.offset = 0;
+    c.remaining = 0;
+    c.closing = false;
+    c.eof = false;
+    c.writing = false;
+    c.active = time(NULL);
+    c.peer = peer;
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+      close(fd);
+      connections.erase(fd);
+    }
+  }
+}
+
+// One worker of the pool: all its connections in a single epoll loop,
+// requests answered one at a time. Workers share the listener and only
+// one of them is woken per connection.
+static int worker(int listener, HTTP_HANDLER handler) {
+  int epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll < 0)
+    return (1);
+
+  struct epoll_event event;
+  event.events = EPOLLIN | EPOLLEXCLUSIVE;
+  event.data.fd = listener;
+  if (epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) != 0)
+    return (1);
+
+  map<int, HTTP_CONNECTION> connections;
+  time_t swept = time(NULL);
+  struct epoll_event events[64];
+  while (!stopping) {
+    int n = epoll_wait(epoll, events, 64, 1000);
+    if (n < 0 && errno != EINTR)
+      return (1);
+
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if (fd == listener) {
+        accepted(epoll, listener, connections);
+        continue;
+      }
+
+      map<int, HTTP_CONNECTION>::iterator it = connections.find(fd);
+      if (it == connections.end())
+        continue;
+
+      HTTP_CONNECTION &c = it->second;
+      bool open = !(events[i].events & EPOLLERR);
+      if (open && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+        open = receive(fd, c);
+      if (open)
+        open = progress(fd, c, handler);
+      if (open)
+        watch(epoll, fd, c);
+      else
+        release(epoll, connections, it);
+    }
+
+    // idle connections, and clients that stopped reading, are dropped
+    time_t now = time(NULL);
+    if (now != swept) {
+      swept = now;
+      for (map<int, HTTP_CONNECTION>::iterator it = connections.begin();
+           it != connections.end();) {
+        map<int, HTTP_CONNECTION>::iterator next = it;
+        next++;
+        if (now - it->second.active > HTTP_IDLE)
+          release(epoll, connections, it);
+        it = next;
+      }
+    }
+  }
+
+  while (!connections.empty())
+    release(epoll, connections, connections.begin());
+  close(epoll);
+
+  return (0);
+}
+
+// Forks workers that each serve the listener, and replaces those that
+// exit, until SIGINT or SIGTERM.
+int httpServe(int listener, int workers, HTTP_HANDLER handler) {
+  signal(SIGPIPE, SIG_IGN);
+  fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  vector<pid_t> pool;
+  while (!stopping) {
+    while (static_cast<int>(pool.size()) < workers) {
+      pid_t pid = fork();
+      if (pid < 0)
+        break;
+      if (pid == 0)
+        _exit(worker(listener, handler));
+      pool.push_back(pid);
+    }
+
+    pid_t pid = wait(NULL);
+    if (pid < 0 && errno == EINTR)
+      continue;
+    if (pid < 0)
+      return (-1);
+
+    // a worker that keeps failing is not restarted in a tight loop
+    pool.erase(remove(pool.begin(), pool.end(), pid), pool.end());
+    if (!stopping)
+      sleep(1);
+  }
+
+  for (size_t i = 0; i < pool.size(); i++)
+    kill(pool[i], SIGTERM);
+  while (wait(NULL) > 0 || errno == EINTR)
+    ;
+
+  return (0);
+}
@@ -0,0 +1,36 @@
+/**
+ *  @file   http.h
+ *  @brief  HTTP/1.1 server
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef HTTP_H_
+#define HTTP_H_
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+// largest request line and headers accepted
+#define HTTP_HEADER_LIMIT 65536
+
+// seconds a kept-alive connection may stay idle
+#define HTTP_IDLE 30
+
+typedef struct {
+  map<string, string> params;
+  string in;
+  bool keepAlive;
+} HTTP_REQUEST;
+
+// answers a request with CGI output: header lines, an empty line, the body
+typedef void (*HTTP_HANDLER)(const HTTP_REQUEST &request, string &output);
+
+int httpListen(const char *address);
+int httpServe(int listener, int workers, HTTP_HANDLER handler);
+
+#endif // HTTP_H_
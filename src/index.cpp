@@ -0,0 +1,298 @@
+/**
+ *  @file   index.cpp
+ *  @brief  Entry offset index for the log file
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "days.h"
+
+static const char indexMagic[8] = {'B', 'o', 'L', 'i', 'd', 'x', '3', '\0'};
+
+static bool stampMatches(const INDEX_HEADER *header,
+                         const struct stat &f_stat) {
+  return (header->size == static_cast<uint64_t>(f_stat.st_size) &&
+          header->mtime == static_cast<int64_t>(f_stat.st_mtime) &&
+          header->inode == static_cast<uint64_t>(f_stat.st_ino));
+}
+
+static size_t layoutLength(uint32_t count) {
+  return (sizeof(INDEX_HEADER) + count * sizeof(INDEX_RECORD) +
+          2 * count * sizeof(uint32_t));
+}
+
+static void layout(LOG_INDEX &index, const char *data) {
+  index.header = reinterpret_cast<const INDEX_HEADER *>(data);
+  index.records =
+      reinterpret_cast<const INDEX_RECORD *>(data + sizeof(INDEX_HEADER));
+  index.order = reinterpret_cast<const uint32_t *>(
+      data + sizeof(INDEX_HEADER) +
+      index.header->count * sizeof(INDEX_RECORD));
+  index.rank = index.order + index.header->count;
+}
+
+// records are ordered by date, IDs that are not a date come first
+static int compare(const INDEX_RECORD &record, uint32_t key, const char *ID) {
+  if (record.key != key)
+    return (record.key < key ? -1 : 1);
+  return (memcmp(record.ID, ID, 8));
+}
+
+static bool lessID(const INDEX_RECORD *records, uint32_t a, uint32_t b) {
+  return (compare(records[a], records[b].key, records[b].ID) < 0);
+}
+
+static long lowerBound(const LOG_INDEX &index, uint32_t key, const char *ID) {
+  long low = 0, high = index.header->count;
+  while (low < high) {
+    long mid = (low + high) / 2;
+    if (compare(index.records[index.order[mid]], key, ID) < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return (low);
+}
+
+static ERROR_CODE mapIndex(LOG_INDEX &index, uint32_t kind) {
+  int fd = open(index.path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return (IO_READ);
+
+  struct stat i_stat;
+  if (fstat(fd, &i_stat) != 0 ||
+      static_cast<size_t>(i_stat.st_size) < sizeof(INDEX_HEADER)) {
+    close(fd);
+    return (STRUCTURE);
+  }
+
+  void *map = mmap(NULL, i_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return (IO_READ);
+
+  const INDEX_HEADER *header = static_cast<const INDEX_HEADER *>(map);
+  if (memcmp(header->magic, indexMagic, 8) != 0 ||
+      layoutLength(header->count) != static_cast<size_t>(i_stat.st_size) ||
+      header->kind != kind) {
+    munmap(map, i_stat.st_size);
+    return (STRUCTURE);
+  }
+
+  index.map = map;
+  index.mapLength = i_stat.st_size;
+  layout(index, static_cast<const char *>(map));
+
+  return (OK);
+}
+
+ERROR_CODE indexWrite(LOG_INDEX &index, const string &log, uint32_t kind,
+                      const struct stat &f_stat, uint64_t end,
+                      const vector<INDEX_RECORD> &records) {
+  indexClose(index);
+  index.path = log + ".idx";
+
+  uint32_t count = records.size();
+
+  vector<uint32_t> order(count);
+  for (uint32_t i = 0; i < count; i++)
+    order[i] = i;
+  const INDEX_RECORD *base = count ? &records[0] : NULL;
+  stable_sort(order.begin(), order.end(), [base](uint32_t a, uint32_t b) {
+    return (lessID(base, a, b));
+  });
+
+  vector<uint32_t> rank(count);
+  for (uint32_t i = 0; i < count; i++)
+    rank[order[i]] = i;
+
+  INDEX_HEADER header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, indexMagic, 8);
+  header.size = f_stat.st_size;
+  header.mtime = f_stat.st_mtime;
+  header.inode = f_stat.st_ino;
+  header.count = count;
+  header.kind = kind;
+  header.end = end;
+
+  string data;
+  data.reserve(layoutLength(count));
+  data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (count) {
+    data.append(reinterpret_cast<const char *>(&records[0]),
+                count * sizeof(INDEX_RECORD));
+    data.append(reinterpret_cast<const char *>(&order[0]),
+                count * sizeof(uint32_t));
+    data.append(reinterpret_cast<const char *>(&rank[0]),
+                count * sizeof(uint32_t));
+  }
+
+  string tmp = index.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  if (!ofstr.fail()) {
+    ofstr.write(data.data(), data.length());
+    ofstr.close();
+    if (!ofstr.fail() && rename(tmp.c_str(), index.path.c_str()) == 0 &&
+        mapIndex(index, kind) == OK)
+      return (OK);
+  }
+  unlink(tmp.c_str());
+
+  // the sidecar could not be written; keep serving from memory
+  index.map = new char[data.length()];
+  index.mapLength = 0;
+  memcpy(index.map, data.data(), data.length());
+  layout(index, static_cast<const char *>(index.map));
+
+  return (OK);
+}
+
+ERROR_CODE indexLoad(const string &log, uint32_t kind, LOG_INDEX &index) {
+  indexClose(index);
+  index.path = log + ".idx";
+
+  return (mapIndex(index, kind));
+}
+
+bool indexCurrent(const LOG_INDEX &index, const struct stat &f_stat) {
+  return (index.map != NULL && stampMatches(index.header, f_stat));
+}
+
+void indexClose(LOG_INDEX &index) {
+  if (index.map != NULL) {
+    if (index.mapLength)
+      munmap(index.map, index.mapLength);
+    else
+      delete[] static_cast<char *>(index.map);
+  }
+  index.map = NULL;
+  index.mapLength = 0;
+  index.header = NULL;
+  index.records = NULL;
+  index.order = NULL;
+  index.rank = NULL;
+}
+
+long indexFind(const LOG_INDEX &index, const string &ID) {
+  if (index.map == NULL || ID.length() != 8)
+    return (-1);
+
+  uint32_t key = dayKey(ID);
+  long low = lowerBound(index, key, ID.data());
+  if (low < static_cast<long>(index.header->count) &&
+      compare(index.records[index.order[low]], key, ID.data()) == 0)
+    return (index.order[low]);
+
+  return (-1);
+}
+
+long indexNeighbour(const LOG_INDEX &index, long pos, long step) {
+  if (pos < 0 || pos >= indexCount(index) || index.records[pos].key == 0)
+    return (-1);
+
+  long at = index.rank[pos] + step;
+  if (at < 0 || at >= indexCount(index) ||
+      index.records[index.order[at]].key == 0)
+    return (-1);
+
+  return (index.order[at]);
+}
+
+// the oldest or the newest entry with a date, -1 when there is none
+long indexEdge(const LOG_INDEX &index, bool newest) {
+  const char lowest[8] = {0};
+  long count = indexCount(index),
+       first = count > 0 ? lowerBound(index, 1, lowest) : 0;
+  if (first >= count)
+    return (-1);
+
+  return (index.order[newest ? count - 1 : first]);
+}
+
+void indexRange(const LOG_INDEX &index, uint32_t from, uint32_t to,
+                vector<long> &positions) {
+  if (index.map == NULL || from == 0 || from > to)
+    return;
+
+  // newest first, like the log itself
+  const char lowest[8] = {0};
+  long first = lowerBound(index, from, lowest),
+       last = to == UINT32_MAX ? indexCount(index)
+                               : lowerBound(index, to + 1, lowest);
+  for (long at = last; at-- > first;)
+    positions.push_back(index.order[at]);
+}
+
+void indexPage(const LOG_INDEX &index, uint32_t key, bool older, size_t limit,
+               vector<long> &positions) {
+  if (index.map == NULL)
+    return;
+
+  // only the entries on the page are visited, going older from before key
+  // newest first and going newer from after key oldest first
+  const char lowest[8] = {0};
+  long count = index.header->count;
+  if (older)
+    for (long at = lowerBound(index, key, lowest);
+         at-- > 0 && positions.size() < limit &&
+         index.records[index.order[at]].key != 0;)
+      positions.push_back(index.order[at]);
+  else if (key < UINT32_MAX)
+    for (long at = lowerBound(index, key + 1, lowest);
+         at < count && positions.size() < limit; at++)
+      positions.push_back(index.order[at]);
+}
+
+long indexCount(const LOG_INDEX &index) {
+  return (index.map == NULL ? 0 : index.header->count);
+}
+
+string indexID(const LOG_INDEX &index, long pos) {
+  if (pos < 0 || pos >= indexCount(index))
+    return ("");
+
+  return (string(index.records[pos].ID, 8));
+}
+
+uint32_t indexKey(const LOG_INDEX &index, long pos) {
+  if (pos < 0 || pos >= indexCount(index))
+    return (0);
+
+  return (index.records[pos].key);
+}
+
+void indexRecords(const LOG_INDEX &index, vector<INDEX_RECORD> &records) {
+  if (index.map == NULL)
+    records.clear();
+  else
+    records.assign(index.records, index.records + index.header->count);
+}
+
+INDEX_RECORD indexRecord(const string &ID, uint64_t offset, uint64_t length,
+                         uint32_t version) {
+  INDEX_RECORD record;
+  memset(&record, 0, sizeof(record));
+  memset(record.ID, ' ', 8);
+  memcpy(record.ID, ID.data(), ID.length() < 8 ? ID.length() : 8);
+  record.version = version;
+  record.key = dayKey(ID);
+  record.offset = offset;
+  record.length = length;
+
+  return (record);
+}
@@ -0,0 +1,77 @@
+/**
+ *  @file   index.h
+ *  @brief  Entry offset index for the log file
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef INDEX_H_
+#define INDEX_H_
+
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+#define INDEX_TEXT 0
+#define INDEX_SEGMENT 1
+
+typedef struct {
+  char magic[8];
+  uint64_t size;
+  int64_t mtime;
+  uint64_t inode;
+  uint32_t count;
+  uint32_t kind;
+  uint64_t end;
+} INDEX_HEADER;
+
+typedef struct {
+  char ID[8];
+  uint32_t version;
+  uint32_t key;
+  uint64_t offset;
+  uint64_t length;
+} INDEX_RECORD;
+
+typedef struct {
+  string path;
+  void *map;
+  size_t mapLength;
+  const INDEX_HEADER *header;
+  const INDEX_RECORD *records;
+  const uint32_t *order;
+  const uint32_t *rank;
+} LOG_INDEX;
+
+ERROR_CODE indexLoad(const string &log, uint32_t kind, LOG_INDEX &index);
+bool indexCurrent(const LOG_INDEX &index, const struct stat &f_stat);
+ERROR_CODE indexWrite(LOG_INDEX &index, const string &log, uint32_t kind,
+                      const struct stat &f_stat, uint64_t end,
+                      const vector<INDEX_RECORD> &records);
+void indexClose(LOG_INDEX &index);
+
+void indexRecords(const LOG_INDEX &index, vector<INDEX_RECORD> &records);
+INDEX_RECORD indexRecord(const string &ID, uint64_t offset, uint64_t length,
+                         uint32_t version = 0);
+
+long indexFind(const LOG_INDEX &index, const string &ID);
+long indexNeighbour(const LOG_INDEX &index, long pos, long step);
+long indexEdge(const LOG_INDEX &index, bool newest);
+void indexRange(const LOG_INDEX &index, uint32_t from, uint32_t to,
+                vector<long> &positions);
+void indexPage(const LOG_INDEX &index, uint32_t key, bool older, size_t limit,
+               vector<long> &positions);
+long indexCount(const LOG_INDEX &index);
+string indexID(const LOG_INDEX &index, long pos);
+uint32_t indexKey(const LOG_INDEX &index, long pos);
+
+#endif // INDEX_H_
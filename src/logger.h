@@ -0,0 +1,44 @@
+/**
+ *  @file   logger.h
+ *  @brief  Daily Logger
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <string>
+
+using namespace std;
+
+typedef enum {
+  OK,
+  CONFIG_READ,
+  CONFIG_WRITE,
+  IO_READ,
+  IO_WRITE,
+  NO_QUERY,
+  NOT_FOUND,
+  STRUCTURE,
+  UNKNOWN,
+  TOO_LARGE,
+  INCOMPLETE
+} ERROR_CODE;
+
+typedef string PREV_NEXT[2];
+
+#define PREV 0
+#define NEXT 1
+
+extern const char *entries;
+extern const char *endEntries;
+
+extern const char *entryID;
+
+extern const char *contentID;
+extern const char *endContent;
+
+#endif // LOGGER_H_
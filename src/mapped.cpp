@@ -0,0 +1,86 @@
+/**
+ *  @file   mapped.cpp
+ *  @brief  Memory-mapped read-only files
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "mapped.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+ERROR_CODE mapOpen(const string &path, MAPPED_FILE &file) {
+  struct stat f_stat;
+  if (stat(path.c_str(), &f_stat) != 0)
+    return (IO_READ);
+
+  if (file.data != NULL && file.path == path &&
+      file.f_stat.st_ino == f_stat.st_ino &&
+      file.f_stat.st_size == f_stat.st_size &&
+      file.f_stat.st_mtime == f_stat.st_mtime)
+    return (OK);
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return (IO_READ);
+
+  // map what was opened, the path may have been replaced since the stat
+  if (fstat(fd, &f_stat) != 0) {
+    close(fd);
+    return (IO_READ);
+  }
+
+  const char *data = "";
+  if (f_stat.st_size > 0) {
+    void *map = mmap(NULL, f_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      return (IO_READ);
+    }
+    data = static_cast<const char *>(map);
+  }
+  close(fd);
+
+  mapClose(file);
+  file.path = path;
+  file.data = data;
+  file.length = f_stat.st_size;
+  file.f_stat = f_stat;
+
+  return (OK);
+}
+
+void mapClose(MAPPED_FILE &file) {
+  if (file.data != NULL && file.length > 0)
+    munmap(const_cast<char *>(file.data), file.length);
+  file.data = NULL;
+  file.length = 0;
+}
+
+const char *mapFind(const char *begin, const char *end, const char *marker) {
+  if (begin >= end)
+    return (NULL);
+
+  return (static_cast<const char *>(
+      memmem(begin, end - begin, marker, strlen(marker))));
+}
+
+const char *mapLineStart(const char *begin, const char *at) {
+  while (at > begin && at[-1] != '\n')
+    at--;
+
+  return (at);
+}
+
+const char *mapLineEnd(const char *at, const char *end) {
+  const char *eol =
+      static_cast<const char *>(memchr(at, '\n', end > at ? end - at : 0));
+
+  return (eol == NULL ? end : eol);
+}
@@ -0,0 +1,36 @@
+/**
+ *  @file   mapped.h
+ *  @brief  Memory-mapped read-only files
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef MAPPED_H_
+#define MAPPED_H_
+
+#include <sys/stat.h>
+
+#include <string>
+#include <string_view>
+
+#include "logger.h"
+
+using namespace std;
+
+typedef struct {
+  string path;
+  const char *data;
+  size_t length;
+  struct stat f_stat;
+} MAPPED_FILE;
+
+ERROR_CODE mapOpen(const string &path, MAPPED_FILE &file);
+void mapClose(MAPPED_FILE &file);
+
+const char *mapFind(const char *begin, const char *end, const char *marker);
+const char *mapLineStart(const char *begin, const char *at);
+const char *mapLineEnd(const char *at, const char *end);
+
+#endif // MAPPED_H_
@@ -0,0 +1,290 @@
+/**
+ *  @file   pages.cpp
+ *  @brief  Default page templates
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "template.h"
+
+// file names of the pages a theme can replace, see templateTheme()
+const char *const pageNames[TEMPLATES] = {
+    "header", "menu",    "footer", "error",          "setup", "entry",
+    "edit",   "results", "result", "results-footer", "pages", "stats"};
+
+const char *const pageSources[TEMPLATES] = {
+    // PAGE_HEADER
+    R"html(<!DOCTYPE html PUBLIC "-//W3C//DTD XHTML 1.0 Transitional//EN" "http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd">
+
+<html xmlns="http://www.w3.org/1999/xhtml">
+
+  <head>
+
+    <link rel="SHORTCUT ICON" href="{{base}}/bol.ico" />
+
+    <link rel="stylesheet" href="{{base}}{{plugin}}{{scheme}}.css" type="text/css" />
+
+    <title>Boersma online Logbook - BoL</title>
+
+    <meta name="description" content="Homepage Christiaan Boersma" />
+    <meta name="keywords" content="Christiaan, Boersma, RuG" />
+
+    <meta name="resource-type" content="document" />
+    <meta name="robots" content="noimageclick" />
+     <meta name="pragma" content="no-cache" />
+
+</head>
+
+<body class="main">
+
+)html",
+
+    // PAGE_MENU
+    R"html(<br />
+<br />
+<form name="search" action="{{self}}?action=search&ID=000000" method="get">
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="10" class="menu" >
+  <tr>
+    <td valign="bottom">
+      <span title="Edit today"><a href="{{self}}?action=today" onmouseover="window.status='Today';return true" onmouseout="window.status=' '">&nbsp;Today&nbsp;</a></span>&nbsp; &nbsp;<span title="View all entries"><a href="{{self}}?action=view&limit={{pageSize}}" onmouseover="window.status='View Entries';return true" onmouseout="window.status=' '">&nbsp;View All&nbsp;</a></span> &nbsp; &nbsp;  &nbsp; &nbsp; <span title="BoL Setup"><a href="{{self}}?action=setup" onmouseover="window.status='BoL Configuration';return true" onmouseout="window.status=' '">&nbsp;Setup&nbsp;</a></span>
+    </td>
+    <td align="right" valign="bottom">
+        <input type="hidden" name="action" value="search"/><span title="Search, hot-key Alt + S, Ctrl + S (Apple)"><input type="hidden" name="ID" value="000000"/><input class="search" type="text" name="match" size="30" value="{{match}}" accesskey="s"/> &nbsp; <a href="JavaScript:document.search.submit()" onmouseover="window.status='Search';return true" onmouseout="window.status=' '">&nbsp;Search&nbsp;</a></span>
+   </td>
+  </tr>
+</table>
+</form>
+)html",
+
+    // PAGE_FOOTER
+    R"html(<br />
+<table align="center" width="600" rules="none" cellspacing="1" cellpadding="3" class="menu">
+  <tr>
+    <td align="left">
+version 2.1
+    </td>
+    <td align="right">
+&#169; Christiaan Boersma (2004/{{year}})
+    </td>
+  </tr>
+</table>
+</body>
+
+</html>
+)html",
+
+    // PAGE_ERROR
+    R"html(<br />
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="menu">
+  <tr>
+    <td>
+      <H1>An error occured!</H1>
+      <br />
+      Cannot execute: <i><b>{{query}}</i></b><br />
+      Error code    : <i><b>{{code}}</i></b><br />
+      &nbsp;&nbsp; {{message}}<br />
+      <br />
+      If the error persists contact the administrator:<br />
+      <br />
+      <a href="mailto:{{administrator}}" onmouseover="window.status='Contact the Administrator';return true" onmouseout="window.status=' '">{{administrator}}</a><br />
+      <br />
+    </td>
+  </tr>
+</table>
+)html",
+
+    // PAGE_SETUP
+    R"html(<br />
+<form name="setup" action="{{self}}?action=setup" method="POST">
+<input type="hidden" name="save" value="true" />
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="menu">
+  <tr>
+    <td colspan="2">
+      <h1>BoL Setup</h1>
+      <h2>General</h2>
+    </td>
+  </tr>
+  <tr>
+    <td width="20%">
+      Log file 
+    </td>
+    <td>
+      <input class="setup" type="text" name="log" value="{{log}}" /> {{&logStatus}}
+    </td>
+  </tr>
+  <tr>
+    <td>
+      Base URL 
+    </td>
+    <td>
+      <input class="setup" type="text" name="base" value="{{base}}" />
+    </td>
+  </tr>
+  <tr>
+    <td>
+      Plugin DIR 
+    </td>
+    <td>
+      <input class="setup" type="text" name="plugin" value="{{plugin}}" /> {{&pluginStatus}}
+    </td>
+  </tr>
+  <tr>
+    <td>
+      Administrator
+    </td>
+    <td>
+      <input class="setup" type="text" name="administrator" value="{{administrator}}" />
+    </td>
+  </tr>
+  <tr>
+    <td colspan="2">
+      <h2>Look &amp; Feel</h2>
+    </td>
+  </tr>
+  <tr>
+    <td>
+      Theme
+    </td>
+    <td>
+{{&themes}}
+    </td>
+  </tr>
+  <tr>
+    <td colspan="2" align="right">
+      <span title="Save setup"><a href="javascript:document.setup.submit();" onmouseover="window.status='Save setup';return true" onmouseout="window.status=' '">&nbsp;Save&nbsp;</a></span> <span title="Undo changes"><a href="javascript:document.setup.reset();" onmouseover="window.status='Undo changes';return true" onmouseout="window.status=' '">&nbsp;Undo&nbsp;</a></span>
+    </td>
+  </tr>
+</table>
+</form>
+)html",
+
+    // PAGE_ENTRY
+    R"html(<br />
+<table align="center" width="600" rules="none" cellspacing="1" cellpadding="3" class="entry">
+  <tr>
+    <td width="50%" align="left">
+{{#navigation}}{{#previous}}       <span title="View previous ({{previousDate}})"><a href="{{self}}?action=view&ID={{previous}}" onmouseover="window.status='Previous entry';return true" onmouseout="window.status=' '"><img src="{{base}}images/previous.gif" alt="Previous entry" border="0" /></a></span>{{/previous}}{{^previous}}       <img src="{{base}}images/previous_disabled.gif"" alt="disabled">{{/previous}}{{#next}}       <span title="View next ({{nextDate}})"><a href="{{self}}?action=view&ID={{next}}" onmouseover="window.status='Next entry';return true" onmouseout="window.status=' '"><img src="{{base}}images/next.gif" alt="Next entry" border="0" /></a></span>{{/next}}{{^next}}       <img src="{{base}}images/next_disabled.gif"" alt="disabled">{{/next}}{{/navigation}}    </td>
+    <td align="right" class="date">
+{{date}}
+    </td>
+  </tr>
+  <tr>
+    <td colspan="2" valign="top" class="content">
+      <br />
+{{%content}}
+
+      <br />
+    </td>
+  </tr>
+  <tr>
+    <td colspan="2" align="right">
+      <span title="View {{date}}"><a href="{{self}}?action=view&ID={{ID}}" onmouseover="window.status='View alone';return true" onmouseout="window.status=' '">&nbsp;View&nbsp;</a></span>
+      <span title="Edit {{date}}"><a href="{{self}}?action=edit&ID={{ID}}" onmouseover="window.status='Edit entry';return true" onmouseout="window.status=' '">&nbsp;Edit&nbsp;</a></span>
+    </td>
+  </tr>
+</table>
+
+<br />
+)html",
+
+    // PAGE_EDIT
+    R"html(<br />
+<form name="form" action="{{self}}?action=save&ID={{ID}}" method="POST">
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="entry">
+  <tr>
+    <td align="right" class="date">
+{{date}}
+    </td>
+  </tr>
+  <tr>
+    <td align="center" class="content">
+      <br />
+      <textarea name="content" class="wordprocessor">{{content}}</textarea><br />
+
+      <br />
+    </td>
+  </tr>
+  <tr>
+    <td align="right">
+       <a href="JavaScript:document.form.submit()" onmouseover="window.status='Save Entry';return true" onmouseout="window.status=' '">&nbsp;Save&nbsp;</a>
+    </td>
+  </tr>
+</table>
+
+</form>)html",
+
+    // PAGE_RESULTS
+    R"html(<br />
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="menu" >
+  <tr>
+    <td colspan="3">
+      <font size="4"><b>Results for <i>{{match}}</i></b></font><br />
+      <br />
+    </td>
+  </tr>
+    <td align="left" width="210">
+      <i>Date</i>
+    </td>
+    <td align="left" width="360">
+       <i>Content</i>
+    </td>
+    <td align="right" width="30">
+       <i>#</i>
+    </td>
+  </tr>
+)html",
+
+    // PAGE_RESULT
+    R"html(  <tr>
+    <td align="left" valign="top" width="210">
+{{^ID}}      &nbsp;
+{{/ID}}{{#ID}}      <a href="{{self}}?action=view&ID={{ID}}&highlight={{match}}" onmouseover="window.status='View';return true" onmouseout="window.status=' '">{{date}}</a>
+{{/ID}}    </td>
+    <td align="left" width="360">
+{{&content}}
+    </td>
+    <td align="right" width="30">
+      <i><b>{{at}}</b></i>
+    </td>
+  </tr>
+)html",
+
+    // PAGE_RESULTS_FOOTER
+    R"html(  <tr>
+    <td align="right" COLSPAN="3">
+      <font size="5"><b>{{matched}} matches</b></font>
+    </td>
+  </tr>
+</table>
+
+)html",
+
+    // PAGE_PAGES
+    R"html(<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="menu">
+  <tr>
+    <td align="left">
+{{#newer}}      <span title="View the newest entries"><a href="{{self}}?action=view&limit={{limit}}" onmouseover="window.status='Newest entries';return true" onmouseout="window.status=' '">&nbsp;Newest&nbsp;</a></span>
+      <span title="View newer entries"><a href="{{self}}?action=view&limit={{limit}}&cursor={{newer}}&direction=newer" onmouseover="window.status='Newer entries';return true" onmouseout="window.status=' '">&nbsp;Newer&nbsp;</a></span>
+{{/newer}}    </td>
+    <td align="right">
+{{#cursor}}      <span title="View older entries"><a href="{{self}}?action=view&limit={{limit}}&cursor={{cursor}}" onmouseover="window.status='Older entries';return true" onmouseout="window.status=' '">&nbsp;Older&nbsp;</a></span>
+{{/cursor}}    </td>
+  </tr>
+</table>
+
+<br />
+)html",
+
+    // PAGE_STATS
+    R"html(<br />
+<table align="center" width="600" rules="none" cellspacing="0" cellpadding="3" class="menu">
+  <tr>
+    <td colspan="6">
+      <h1>Statistics</h1>
+{{^stats}}      No requests have been recorded. Setting <i>$stats</i> in bol.cfg to a file name records the timing of every request in it.
+{{/stats}}    </td>
+  </tr>
+{{&stats}}</table>
+)html"};
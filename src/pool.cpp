@@ -0,0 +1,185 @@
+/**
+ *  @file   pool.cpp
+ *  @brief  Worker threads shared by the requests of a process
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "pool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Tasks are taken in order, those at limit and beyond wait until the
+// caller has emitted enough of the earlier ones.
+typedef struct {
+  const function<void(size_t)> *task;
+  size_t count;
+  size_t next;
+  size_t limit;
+  vector<char> finished;
+  int helpers;
+  int busy;
+} POOL_JOB;
+
+// Never destroyed, its threads wait on it until the process exits. They
+// are started on first use, after a --serve worker has been forked.
+typedef struct {
+  mutex lock;
+  condition_variable wake;
+  condition_variable done;
+  int started;
+  POOL_JOB *job;
+} POOL;
+
+static POOL *pool = NULL;
+
+static bool poolReady(const POOL_JOB &job) {
+  return (job.next < min(job.count, job.limit));
+}
+
+// runs the tasks that are ready, with the lock held in between
+static void poolTake(POOL_JOB &job, unique_lock<mutex> &guard) {
+  while (poolReady(job)) {
+    size_t i = job.next++;
+    guard.unlock();
+    (*job.task)(i);
+    guard.lock();
+    job.finished[i] = 1;
+    pool->done.notify_all();
+  }
+}
+
+static void poolWorker(void) {
+  unique_lock<mutex> guard(pool->lock);
+  while (true) {
+    pool->wake.wait(guard, [] {
+      return (pool->job != NULL && pool->job->helpers > 0 &&
+              poolReady(*pool->job));
+    });
+    POOL_JOB &job = *pool->job;
+    job.helpers--;
+    job.busy++;
+
+    while (job.next < job.count) {
+      poolTake(job, guard);
+      pool->wake.wait(
+          guard, [&job] { return (poolReady(job) || job.next >= job.count); });
+    }
+
+    if (--job.busy == 0)
+      pool->done.notify_all();
+  }
+}
+
+// starts the job with the lock held, and the threads it needs if the
+// pool does not have them yet
+static void poolStart(POOL_JOB &job) {
+  try {
+    for (; pool->started < job.helpers; pool->started++)
+      thread(poolWorker).detach();
+  } catch (const system_error &) {
+    job.helpers = pool->started;
+  }
+  pool->job = &job;
+  pool->wake.notify_all();
+}
+
+static void poolFinish(POOL_JOB &job, unique_lock<mutex> &guard) {
+  job.helpers = 0;
+  pool->done.wait(guard, [&job] { return (job.busy == 0); });
+  pool->job = NULL;
+}
+
+static void poolJob(POOL_JOB &job, const function<void(size_t)> &task,
+                    size_t count, int helpers) {
+  if (pool == NULL) {
+    pool = new POOL;
+    pool->started = 0;
+    pool->job = NULL;
+  }
+
+  job.task = &task;
+  job.count = count;
+  job.next = 0;
+  job.limit = count;
+  job.finished.assign(count, 0);
+  job.helpers = static_cast<int>(min<size_t>(helpers, count));
+  job.busy = 0;
+}
+
+// the configured number of threads, or one a processor when it is not set,
+// but no more than there are POOL_CUTOFF bytes for
+int poolThreads(int configured, size_t bytes) {
+  size_t threads = configured > 0 ? configured : thread::hardware_concurrency();
+
+  return (static_cast<int>(max<size_t>(1, min(threads, bytes / POOL_CUTOFF))));
+}
+
+// Runs task(0) to task(count - 1) on up to threads threads, the calling
+// one among them, and returns once all have run.
+void poolRun(size_t count, int threads, const function<void(size_t)> &task) {
+  if (threads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++)
+      task(i);
+    return;
+  }
+
+  POOL_JOB job;
+  poolJob(job, task, count, threads - 1);
+
+  unique_lock<mutex> guard(pool->lock);
+  poolStart(job);
+  poolTake(job, guard);
+  poolFinish(job, guard);
+}
+
+// Runs task(i) for every i on the pool and emit(i) in order on the calling
+// thread, each as soon as its task has run. Tasks run at most window ahead
+// of the one emitted last, which bounds what they hold on to. When the next
+// task has not been taken yet the caller runs it itself.
+void poolStream(size_t count, int threads, size_t window,
+                const function<void(size_t)> &task,
+                const function<void(size_t)> &emit) {
+  if (threads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+      emit(i);
+    }
+    return;
+  }
+
+  POOL_JOB job;
+  poolJob(job, task, count, threads - 1);
+  job.limit = max<size_t>(window, 1);
+
+  unique_lock<mutex> guard(pool->lock);
+  poolStart(job);
+  for (size_t i = 0; i < count; i++) {
+    while (!job.finished[i]) {
+      if (job.next != i) {
+        pool->done.wait(guard);
+        continue;
+      }
+      job.next++;
+      guard.unlock();
+      task(i);
+      guard.lock();
+      job.finished[i] = 1;
+    }
+
+    guard.unlock();
+    emit(i);
+    guard.lock();
+
+    job.limit = i + 1 + max<size_t>(window, 1);
+    pool->wake.notify_all();
+  }
+  poolFinish(job, guard);
+}
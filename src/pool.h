@@ -0,0 +1,32 @@
+/**
+ *  @file   pool.h
+ *  @brief  Worker threads shared by the requests of a process
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+
+#include <functional>
+
+using namespace std;
+
+// bytes of entries a thread should have to itself before it is worth
+// handing them to another one
+#define POOL_CUTOFF 262144
+
+// tasks a thread may run ahead of the caller streaming their results
+#define POOL_WINDOW 8
+
+int poolThreads(int configured, size_t bytes);
+void poolRun(size_t count, int threads, const function<void(size_t)> &task);
+void poolStream(size_t count, int threads, size_t window,
+                const function<void(size_t)> &task,
+                const function<void(size_t)> &emit);
+
+#endif // POOL_H_
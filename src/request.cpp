@@ -0,0 +1,220 @@
+/**
+ *  @file   request.cpp
+ *  @brief  Query string and form body parsing
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "request.h"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "search.h"
+
+// Reads exactly the CONTENT_LENGTH bytes of the body. The length is
+// checked before anything is read, so an oversized request is turned
+// down without being buffered.
+ERROR_CODE requestBody(istream &in, const char *length, string &body) {
+  const size_t chunk = 65536;
+
+  body.clear();
+  if (length == NULL || *length == '\0')
+    return (OK);
+
+  char *end;
+  unsigned long long size = strtoull(length, &end, 10);
+  if (*end != '\0' || *length == '-')
+    return (OK);
+  if (size > REQUEST_LIMIT)
+    return (TOO_LARGE);
+
+  body.resize(size);
+  size_t filled = 0;
+  while (filled < body.length()) {
+    streamsize n =
+        in.rdbuf()->sgetn(&body[filled], min(body.length() - filled, chunk));
+    if (n <= 0)
+      break;
+    filled += n;
+  }
+
+  if (filled < body.length()) {
+    body.clear();
+    return (INCOMPLETE);
+  }
+
+  return (OK);
+}
+
+// splits name=value pairs on '&' once; the fields point into data, which
+// has to outlive the form, and are decoded only when asked for
+void formParse(string_view data, FORM &form) {
+  form.clear();
+
+  size_t begin = 0;
+  while (begin < data.length()) {
+    size_t end = data.find('&', begin);
+    if (end == string_view::npos)
+      end = data.length();
+
+    string_view field = data.substr(begin, end - begin);
+    size_t equals = field.find('=');
+    if (!field.empty()) {
+      if (equals == string_view::npos)
+        form.push_back(FORM_FIELD(field, string_view()));
+      else
+        form.push_back(
+            FORM_FIELD(field.substr(0, equals), field.substr(equals + 1)));
+    }
+    begin = end + 1;
+  }
+}
+
+// the still encoded value of the first field called name
+string_view formRaw(const FORM &form, string_view name) {
+  for (size_t idx = 0; idx < form.size(); idx++)
+    if (form[idx].first == name)
+      return (form[idx].second);
+  return (string_view());
+}
+
+string formValue(const FORM &form, string_view name) {
+  return (decodeURL(formRaw(form, name)));
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9')
+    return (c - '0');
+  if (c >= 'a' && c <= 'f')
+    return (c - 'a' + 10);
+  if (c >= 'A' && c <= 'F')
+    return (c - 'A' + 10);
+  return (-1);
+}
+
+string decodeURL(string_view URLencoded) {
+  string URLdecoded;
+  URLdecoded.reserve(URLencoded.length());
+
+  SEARCH_SET special;
+  searchSet("%+", '\0', special);
+
+  size_t begin = 0, length = URLencoded.length(), idx = 0;
+  for (; (idx = searchAny(special, URLencoded, idx)) != string_view::npos;
+       idx++) {
+    URLdecoded.append(URLencoded.data() + begin, idx - begin);
+    int high, low;
+    if (URLencoded[idx] == '+')
+      URLdecoded += ' ';
+    else if (length - idx > 2 && (high = hexDigit(URLencoded[idx + 1])) >= 0 &&
+             (low = hexDigit(URLencoded[idx + 2])) >= 0) {
+      URLdecoded += static_cast<char>(high << 4 | low);
+      idx += 2;
+    } else {
+      // anything else is read the way strtol reads it
+      char hex[3] = {0, 0, 0};
+      size_t digits = min(static_cast<size_t>(2), length - idx - 1);
+      memcpy(hex, URLencoded.data() + idx + 1, digits);
+      URLdecoded += static_cast<char>(strtol(hex, NULL, 16));
+      idx += digits;
+    }
+    begin = idx + 1;
+  }
+  URLdecoded.append(URLencoded.data() + begin, length - begin);
+
+  return (URLdecoded);
+}
+
+// Whether an Accept-Encoding list allows coding, by name or as "*", with
+// a quality above 0. A coding listed by name overrules "*".
+bool requestAccepts(const char *acceptEncoding, string_view coding) {
+  if (acceptEncoding == NULL)
+    return (false);
+
+  string_view list(acceptEncoding);
+  int named = -1, any = -1;
+  size_t begin = 0;
+  while (begin < list.length()) {
+    size_t end = list.find(',', begin);
+    if (end == string_view::npos)
+      end = list.length();
+
+    string_view item = list.substr(begin, end - begin);
+    size_t semicolon = item.find(';');
+    string_view name = item.substr(0, semicolon);
+    size_t first = name.find_first_not_of(" \t"),
+           last = name.find_last_not_of(" \t");
+    name = first == string_view::npos
+               ? string_view()
+               : name.substr(first, last - first + 1);
+
+    // q=0 turns a coding down, anything else accepts it
+    bool accepted = true;
+    if (semicolon != string_view::npos) {
+      string_view parameter = item.substr(semicolon + 1);
+      size_t q = parameter.find("q=");
+      if (q != string_view::npos)
+        accepted = strtod(string(parameter.substr(q + 2)).c_str(), NULL) > 0;
+    }
+
+    if (name.length() == coding.length() &&
+        strncasecmp(name.data(), coding.data(), name.length()) == 0)
+      named = accepted;
+    else if (name == "*")
+      any = accepted;
+    begin = end + 1;
+  }
+
+  return (named >= 0 ? named == 1 : any == 1);
+}
+
+// An If-None-Match list holding the ETag, weakly compared, or "*".
+static bool etagListed(string_view list, const string &etag) {
+  size_t begin = 0;
+  while (begin < list.length()) {
+    size_t end = list.find(',', begin);
+    if (end == string_view::npos)
+      end = list.length();
+
+    string_view tag = list.substr(begin, end - begin);
+    size_t first = tag.find_first_not_of(" \t"),
+           last = tag.find_last_not_of(" \t");
+    if (first != string_view::npos) {
+      tag = tag.substr(first, last - first + 1);
+      if (tag.substr(0, 2) == "W/")
+        tag.remove_prefix(2);
+      if (tag == "*" || tag == etag)
+        return (true);
+    }
+    begin = end + 1;
+  }
+
+  return (false);
+}
+
+// Whether the client already has the response with this ETag and
+// modification time, 0 if it has none yet. If-Modified-Since only counts
+// when there is no If-None-Match, as in RFC 7232.
+bool requestUnchanged(const char *ifNoneMatch, const char *ifModifiedSince,
+                      const string &etag, time_t modified) {
+  if (ifNoneMatch != NULL)
+    return (etagListed(ifNoneMatch, etag));
+
+  if (ifModifiedSince == NULL || modified == 0)
+    return (false);
+
+  struct tm since;
+  memset(&since, 0, sizeof(since));
+  const char *end = strptime(ifModifiedSince, "%a, %d %b %Y %H:%M:%S GMT",
+                             &since);
+  if (end == NULL || *end != '\0')
+    return (false);
+
+  return (modified <= timegm(&since));
+}
@@ -0,0 +1,43 @@
+/**
+ *  @file   request.h
+ *  @brief  Query string and form body parsing
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef REQUEST_H_
+#define REQUEST_H_
+
+#include <time.h>
+
+#include <istream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+// largest request body accepted, bodies announcing more are not read
+#define REQUEST_LIMIT 4194304
+
+typedef pair<string_view, string_view> FORM_FIELD;
+typedef vector<FORM_FIELD> FORM;
+
+ERROR_CODE requestBody(istream &in, const char *length, string &body);
+
+void formParse(string_view data, FORM &form);
+string_view formRaw(const FORM &form, string_view name);
+string formValue(const FORM &form, string_view name);
+
+string decodeURL(string_view URLencoded);
+
+bool requestAccepts(const char *acceptEncoding, string_view coding);
+bool requestUnchanged(const char *ifNoneMatch, const char *ifModifiedSince,
+                      const string &etag, time_t modified);
+
+#endif // REQUEST_H_
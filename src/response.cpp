@@ -0,0 +1,249 @@
+/**
+ *  @file   response.cpp
+ *  @brief  Buffered response output
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "response.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+
+#include "stats.h"
+
+// Collects everything written to cout and hands it to the sink in
+// RESPONSE_BUFFER sized blocks. The renderers end every line with endl,
+// which would otherwise cost a write per line; sync() ignores those and
+// only responseFlush() and a full buffer reach the sink. The head, the
+// CGI header lines, is asked for just before the first block goes out so
+// it can report on everything done up to then. Once compress() is
+// called the rest of the body is sent gzip compressed, and can be kept
+// as sent with capture().
+class ResponseBuffer : public streambuf {
+public:
+  ResponseBuffer(RESPONSE_SINK sink, void *context, RESPONSE_HEAD head)
+      : sink(sink), context(context), head(head), started(false),
+        failed(false), compressing(false), pending(false), captured(NULL) {
+    setp(buffer, buffer + sizeof(buffer));
+  }
+
+  ~ResponseBuffer() {
+    if (compressing)
+      deflateEnd(&stream);
+  }
+
+  bool compress(int level) {
+    if (compressing || level <= 0)
+      return (compressing);
+
+    flush();
+    memset(&stream, 0, sizeof(stream));
+    compressing = deflateInit2(&stream, min(level, 9), Z_DEFLATED,
+                               MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    return (compressing);
+  }
+
+  void capture(string *body) { captured = body; }
+
+  // ends the compressed body, after which output goes out as is
+  void finish(void) {
+    flush();
+    if (!compressing)
+      return;
+
+    deflated(NULL, 0, Z_FINISH);
+    deflateEnd(&stream);
+    compressing = false;
+    captured = NULL;
+  }
+
+  void start(void) {
+    if (started)
+      return;
+    started = true;
+
+    if (head != NULL) {
+      string text;
+      head(text);
+      send(text.data(), text.length());
+    }
+  }
+
+  bool flush(void) {
+    if (pptr() > pbase())
+      emit(pbase(), pptr() - pbase());
+    setp(buffer, buffer + sizeof(buffer));
+
+    // what was compressed so far goes out too
+    if (pending) {
+      deflated(NULL, 0, Z_SYNC_FLUSH);
+      pending = false;
+    }
+    return (!failed);
+  }
+
+protected:
+  int_type overflow(int_type c) {
+    flush();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return (traits_type::not_eof(c));
+  }
+
+  streamsize xsputn(const char *s, streamsize n) {
+    streamsize room = epptr() - pptr();
+    if (n <= room) {
+      traits_type::copy(pptr(), s, n);
+      pbump(n);
+      return (n);
+    }
+
+    // large blocks skip the copy once the pending output is out
+    flush();
+    if (n >= static_cast<streamsize>(sizeof(buffer)))
+      emit(s, n);
+    else {
+      traits_type::copy(pptr(), s, n);
+      pbump(n);
+    }
+    return (n);
+  }
+
+  int sync(void) { return (0); }
+
+private:
+  void emit(const char *data, size_t length) {
+    start();
+    if (!compressing) {
+      send(data, length);
+      return;
+    }
+
+    deflated(data, length, Z_NO_FLUSH);
+    pending = true;
+  }
+
+  void deflated(const char *data, size_t length, int mode) {
+    STATS_PHASE phase = statsPhase(STATS_COMPRESS);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = length;
+    do {
+      stream.next_out = reinterpret_cast<Bytef *>(out);
+      stream.avail_out = sizeof(out);
+      deflate(&stream, mode);
+      size_t produced = sizeof(out) - stream.avail_out;
+      if (produced > 0) {
+        send(out, produced);
+        if (captured != NULL)
+          captured->append(out, produced);
+      }
+    } while (stream.avail_out == 0);
+    statsPhase(phase);
+  }
+
+  void send(const char *data, size_t length) {
+    STATS_PHASE phase = statsPhase(STATS_WRITE);
+    // once the client is gone the rest of the response is dropped
+    if (!failed && !sink(data, length, context))
+      failed = true;
+    statsPhase(phase);
+    statsCount(STATS_BYTES_WRITTEN, length);
+  }
+
+  RESPONSE_SINK sink;
+  void *context;
+  RESPONSE_HEAD head;
+  bool started;
+  bool failed;
+  bool compressing;
+  bool pending;
+  z_stream stream;
+  string *captured;
+  char buffer[RESPONSE_BUFFER];
+  char out[RESPONSE_BUFFER];
+};
+
+static ResponseBuffer *response = NULL;
+static streambuf *previous = NULL;
+
+bool responseFd(const char *data, size_t length, void *context) {
+  int fd = *static_cast<int *>(context);
+  while (length > 0) {
+    ssize_t n = write(fd, data, length);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return (false);
+    data += n;
+    length -= n;
+  }
+  return (true);
+}
+
+void responseBegin(RESPONSE_SINK sink, void *context, RESPONSE_HEAD head) {
+  responseEnd();
+
+  response = new ResponseBuffer(sink, context, head);
+  previous = cout.rdbuf(response);
+}
+
+void responseFlush(void) {
+  if (response != NULL)
+    response->flush();
+}
+
+// The rest of the body is sent gzip compressed at level, if above 0.
+// Returns whether it is.
+bool responseCompress(int level) {
+  return (response != NULL && response->compress(level));
+}
+
+// Keeps a copy of the compressed body in body until responseFinish().
+void responseCapture(string *body) {
+  if (response != NULL)
+    response->capture(body);
+}
+
+void responseFinish(void) {
+  if (response != NULL)
+    response->finish();
+}
+
+bool responseEnd(void) {
+  if (response == NULL)
+    return (true);
+
+  // an empty page still gets its head
+  response->flush();
+  response->start();
+  response->finish();
+  bool sent = response->flush();
+  cout.rdbuf(previous);
+  delete response;
+  response = NULL;
+  previous = NULL;
+
+  return (sent);
+}
+
+// t as an HTTP date, for Last-Modified
+string responseDate(time_t t) {
+  struct tm stm;
+  char date[32];
+  gmtime_r(&t, &stm);
+  strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &stm);
+
+  return (date);
+}
@@ -0,0 +1,38 @@
+/**
+ *  @file   response.h
+ *  @brief  Buffered response output
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef RESPONSE_H_
+#define RESPONSE_H_
+
+#include <stddef.h>
+#include <time.h>
+
+#include <string>
+
+using namespace std;
+
+#define RESPONSE_BUFFER 65536
+
+typedef bool (*RESPONSE_SINK)(const char *data, size_t length, void *context);
+typedef void (*RESPONSE_HEAD)(string &head);
+
+bool responseFd(const char *data, size_t length, void *context);
+
+void responseBegin(RESPONSE_SINK sink, void *context,
+                   RESPONSE_HEAD head = NULL);
+void responseFlush(void);
+bool responseEnd(void);
+
+bool responseCompress(int level);
+void responseCapture(string *body);
+void responseFinish(void);
+
+string responseDate(time_t t);
+
+#endif // RESPONSE_H_
@@ -0,0 +1,342 @@
+/**
+ *  @file   search.cpp
+ *  @brief  Case-insensitive substring search
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SEARCH_X86
+#include <immintrin.h>
+#endif
+
+typedef size_t (*SEARCH_KERNEL)(const SEARCH_PATTERN &pattern,
+                                const char *data, size_t length, size_t from);
+typedef size_t (*SCAN_KERNEL)(const SEARCH_SET &set, const char *data,
+                              size_t length, size_t from);
+
+static inline unsigned char fold(unsigned char c) {
+  return (c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+}
+
+static inline unsigned char unfold(unsigned char c) {
+  return (c >= 'a' && c <= 'z' ? c - ('a' - 'A') : c);
+}
+
+// compares the pattern at data, the first and last byte are known to match
+static inline bool matchAt(const SEARCH_PATTERN &pattern, const char *data) {
+  const char *folded = pattern.folded.data();
+  for (size_t j = 1; j + 1 < pattern.folded.length(); j++)
+    if (fold(data[j]) != static_cast<unsigned char>(folded[j]))
+      return (false);
+  return (true);
+}
+
+static size_t findScalar(const SEARCH_PATTERN &pattern, const char *data,
+                         size_t length, size_t from) {
+  size_t n = pattern.folded.length();
+  unsigned char first = pattern.first[0], last = pattern.last[0];
+  for (size_t i = from; i + n <= length; i++)
+    if (fold(data[i]) == first && fold(data[i + n - 1]) == last &&
+        matchAt(pattern, data + i))
+      return (i);
+
+  return (string_view::npos);
+}
+
+static size_t scanScalar(const SEARCH_SET &set, const char *data,
+                         size_t length, size_t from) {
+  for (size_t i = from; i < length; i++) {
+    unsigned char c = data[i];
+    if (c == set.bytes[0] || c == set.bytes[1] || c == set.bytes[2] ||
+        (c == set.doubled && i + 1 < length &&
+         static_cast<unsigned char>(data[i + 1]) == set.doubled))
+      return (i);
+  }
+
+  return (string_view::npos);
+}
+
+#ifdef SEARCH_X86
+
+// candidates are positions where both the first and the last byte of the
+// pattern match in either case, only those are compared in full
+
+__attribute__((target("sse2"))) static size_t
+findSSE2(const SEARCH_PATTERN &pattern, const char *data, size_t length,
+         size_t from) {
+  size_t n = pattern.folded.length(), i = from;
+  const __m128i firstLower = _mm_set1_epi8(pattern.first[0]),
+                firstUpper = _mm_set1_epi8(pattern.first[1]),
+                lastLower = _mm_set1_epi8(pattern.last[0]),
+                lastUpper = _mm_set1_epi8(pattern.last[1]);
+
+  for (; i + n - 1 + 16 <= length; i += 16) {
+    __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)),
+            tail = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(data + i + n - 1));
+    __m128i candidates =
+        _mm_and_si128(_mm_or_si128(_mm_cmpeq_epi8(head, firstLower),
+                                   _mm_cmpeq_epi8(head, firstUpper)),
+                      _mm_or_si128(_mm_cmpeq_epi8(tail, lastLower),
+                                   _mm_cmpeq_epi8(tail, lastUpper)));
+
+    for (unsigned int mask = _mm_movemask_epi8(candidates); mask != 0;
+         mask &= mask - 1) {
+      size_t at = i + __builtin_ctz(mask);
+      if (matchAt(pattern, data + at))
+        return (at);
+    }
+  }
+
+  return (findScalar(pattern, data, length, i));
+}
+
+__attribute__((target("avx2"))) static size_t
+findAVX2(const SEARCH_PATTERN &pattern, const char *data, size_t length,
+         size_t from) {
+  size_t n = pattern.folded.length(), i = from;
+  const __m256i firstLower = _mm256_set1_epi8(pattern.first[0]),
+                firstUpper = _mm256_set1_epi8(pattern.first[1]),
+                lastLower = _mm256_set1_epi8(pattern.last[0]),
+                lastUpper = _mm256_set1_epi8(pattern.last[1]);
+
+  for (; i + n - 1 + 32 <= length; i += 32) {
+    __m256i head =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+            tail = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(data + i + n - 1));
+    __m256i candidates = _mm256_and_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(head, firstLower),
+                        _mm256_cmpeq_epi8(head, firstUpper)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(tail, lastLower),
+                        _mm256_cmpeq_epi8(tail, lastUpper)));
+
+    for (unsigned int mask = _mm256_movemask_epi8(candidates); mask != 0;
+         mask &= mask - 1) {
+      size_t at = i + __builtin_ctz(mask);
+      if (matchAt(pattern, data + at))
+        return (at);
+    }
+  }
+
+  return (findScalar(pattern, data, length, i));
+}
+
+// a byte of the set, or the first of two doubled bytes, ends the scan
+
+__attribute__((target("sse2"))) static size_t
+scanSSE2(const SEARCH_SET &set, const char *data, size_t length, size_t from) {
+  size_t i = from;
+  const __m128i byte0 = _mm_set1_epi8(set.bytes[0]),
+                byte1 = _mm_set1_epi8(set.bytes[1]),
+                byte2 = _mm_set1_epi8(set.bytes[2]),
+                doubled = _mm_set1_epi8(set.doubled);
+
+  for (; i + 1 + 16 <= length; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)),
+            next = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(data + i + 1));
+    __m128i found = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, byte0),
+                     _mm_cmpeq_epi8(block, byte1)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, byte2),
+                     _mm_and_si128(_mm_cmpeq_epi8(block, doubled),
+                                   _mm_cmpeq_epi8(next, doubled))));
+
+    unsigned int mask = _mm_movemask_epi8(found);
+    if (mask != 0)
+      return (i + __builtin_ctz(mask));
+  }
+
+  return (scanScalar(set, data, length, i));
+}
+
+__attribute__((target("avx2"))) static size_t
+scanAVX2(const SEARCH_SET &set, const char *data, size_t length, size_t from) {
+  size_t i = from;
+  const __m256i byte0 = _mm256_set1_epi8(set.bytes[0]),
+                byte1 = _mm256_set1_epi8(set.bytes[1]),
+                byte2 = _mm256_set1_epi8(set.bytes[2]),
+                doubled = _mm256_set1_epi8(set.doubled);
+
+  for (; i + 1 + 32 <= length; i += 32) {
+    __m256i block =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+            next = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(data + i + 1));
+    __m256i found = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, byte0),
+                        _mm256_cmpeq_epi8(block, byte1)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, byte2),
+                        _mm256_and_si256(_mm256_cmpeq_epi8(block, doubled),
+                                         _mm256_cmpeq_epi8(next, doubled))));
+
+    unsigned int mask = _mm256_movemask_epi8(found);
+    if (mask != 0)
+      return (i + __builtin_ctz(mask));
+  }
+
+  return (scanScalar(set, data, length, i));
+}
+
+#endif // SEARCH_X86
+
+static const struct {
+  const char *name;
+  SEARCH_KERNEL kernel;
+  SCAN_KERNEL scan;
+} kernels[] = {
+#ifdef SEARCH_X86
+    {"avx2", findAVX2, scanAVX2},
+    {"sse2", findSSE2, scanSSE2},
+#endif
+    {"scalar", findScalar, scanScalar}};
+
+static const size_t nKernels = sizeof(kernels) / sizeof(kernels[0]);
+
+// the kernel searchSelect() chose, nKernels until it does
+static atomic<size_t> selected(nKernels);
+
+static bool supported(const char *name) {
+#ifdef SEARCH_X86
+  __builtin_cpu_init();
+  if (string(name) == "avx2")
+    return (__builtin_cpu_supports("avx2"));
+  if (string(name) == "sse2")
+    return (__builtin_cpu_supports("sse2"));
+#endif
+  return (string(name) == "scalar");
+}
+
+static size_t widest(void) {
+  size_t chosen = 0;
+  while (chosen < nKernels - 1 && !supported(kernels[chosen].name))
+    chosen++;
+
+  return (chosen);
+}
+
+// the widest kernel the processor supports, found on first use, unless
+// another one was chosen
+static size_t select(void) {
+  static const size_t best = widest();
+  size_t chosen = selected.load(memory_order_relaxed);
+
+  return (chosen < nKernels ? chosen : best);
+}
+
+static SEARCH_KERNEL kernel(void) { return (kernels[select()].kernel); }
+
+void searchCompile(const string &match, SEARCH_PATTERN &pattern) {
+  pattern.folded = match;
+  for (size_t i = 0; i < match.length(); i++)
+    pattern.folded[i] = fold(match[i]);
+
+  unsigned char first = 0, last = 0;
+  if (!match.empty()) {
+    first = pattern.folded[0];
+    last = pattern.folded[match.length() - 1];
+  }
+
+  pattern.first[0] = first;
+  pattern.first[1] = unfold(first);
+  pattern.last[0] = last;
+  pattern.last[1] = unfold(last);
+}
+
+// Up to three bytes, unused ones repeat the first, and optionally a byte
+// that only counts when it is doubled, like the spaces toHTML() replaces.
+void searchSet(const char *bytes, char doubled, SEARCH_SET &set) {
+  size_t count = strlen(bytes);
+  for (size_t i = 0; i < 3; i++)
+    set.bytes[i] = bytes[i < count ? i : 0];
+  set.doubled = doubled != '\0' ? doubled : bytes[0];
+}
+
+size_t searchFind(const SEARCH_PATTERN &pattern, string_view text,
+                  size_t from) {
+  if (from > text.length())
+    return (string_view::npos);
+
+  if (pattern.folded.empty())
+    return (from);
+
+  return (kernel()(pattern, text.data(), text.length(), from));
+}
+
+size_t searchAll(const SEARCH_PATTERN &pattern, string_view text,
+                 vector<size_t> &offsets) {
+  size_t count = 0;
+  if (pattern.folded.empty())
+    return (count);
+
+  SEARCH_KERNEL find = kernel();
+  for (size_t at = 0;
+       (at = find(pattern, text.data(), text.length(), at)) !=
+       string_view::npos;
+       at++, count++)
+    offsets.push_back(at);
+
+  return (count);
+}
+
+// The lines of text holding the pattern, numbered from 1; a match running
+// into the next line does not count. Returns the number of lines in text,
+// the kernel having gone through all of them.
+int searchLines(const SEARCH_PATTERN &pattern, string_view text,
+                vector<SEARCH_LINE> &lines) {
+  int at = 1;
+  size_t begin = 0, end, found, from = 0;
+  while ((found = searchFind(pattern, text, from)) != string_view::npos) {
+    for (; (end = text.find('\n', begin)) < found; begin = end + 1)
+      at++;
+    if (end == string_view::npos)
+      end = text.length();
+
+    if (found + pattern.folded.length() > end) {
+      from = found + 1;
+      continue;
+    }
+
+    SEARCH_LINE line = {begin, end - begin, at};
+    lines.push_back(line);
+
+    begin = from = end + 1;
+    at++;
+  }
+
+  string_view rest = text.substr(min(begin, text.length()));
+  int total = at - 1 + count(rest.begin(), rest.end(), '\n');
+  if (!rest.empty() && rest.back() != '\n')
+    total++;
+
+  return (total);
+}
+
+size_t searchAny(const SEARCH_SET &set, string_view text, size_t from) {
+  if (from >= text.length())
+    return (string_view::npos);
+
+  return (kernels[select()].scan(set, text.data(), text.length(), from));
+}
+
+const char *searchKernel(void) { return (kernels[select()].name); }
+
+bool searchSelect(const string &name) {
+  for (size_t i = 0; i < nKernels; i++)
+    if (name == kernels[i].name && supported(kernels[i].name)) {
+      selected.store(i, memory_order_relaxed);
+      return (true);
+    }
+
+  return (false);
+}
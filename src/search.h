@@ -0,0 +1,50 @@
+/**
+ *  @file   search.h
+ *  @brief  Case-insensitive substring search
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+typedef struct {
+  string folded;
+  unsigned char first[2];
+  unsigned char last[2];
+} SEARCH_PATTERN;
+
+typedef struct {
+  unsigned char bytes[3];
+  unsigned char doubled;
+} SEARCH_SET;
+
+typedef struct {
+  size_t begin;
+  size_t length;
+  int at;
+} SEARCH_LINE;
+
+void searchCompile(const string &match, SEARCH_PATTERN &pattern);
+void searchSet(const char *bytes, char doubled, SEARCH_SET &set);
+
+size_t searchFind(const SEARCH_PATTERN &pattern, string_view text,
+                  size_t from = 0);
+size_t searchAll(const SEARCH_PATTERN &pattern, string_view text,
+                 vector<size_t> &offsets);
+int searchLines(const SEARCH_PATTERN &pattern, string_view text,
+                vector<SEARCH_LINE> &lines);
+size_t searchAny(const SEARCH_SET &set, string_view text, size_t from = 0);
+
+const char *searchKernel(void);
+bool searchSelect(const string &kernel);
+
+#endif // SEARCH_H_
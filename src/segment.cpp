@@ -0,0 +1,251 @@
+/**
+ *  @file   segment.cpp
+ *  @brief  Append-only log segment storage
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "segment.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+const char *beginSegment = "<!--- BEGIN SEGMENT >";
+const char *recordID = "<!--- RECORD ID = ";
+
+// compact once superseded records take up more than half of a segment
+// that has grown beyond this size
+const off_t compactSize = 64 * 1024;
+
+static string recordHeader(const string &ID, uint32_t version,
+                           uint64_t length) {
+  char header[96];
+  snprintf(header, sizeof(header), "%s%.8s VERSION = %u LENGTH = %llu >\n",
+           recordID, ID.c_str(), version,
+           static_cast<unsigned long long>(length));
+  return (header);
+}
+
+static void applyRecord(vector<INDEX_RECORD> &records, map<string, size_t> &ids,
+                        const INDEX_RECORD &record) {
+  string ID(record.ID, 8);
+  map<string, size_t>::iterator it = ids.find(ID);
+  if (it == ids.end()) {
+    ids[ID] = records.size();
+    records.push_back(record);
+  } else
+    records[it->second] = record;
+}
+
+static ERROR_CODE scanSegment(const MAPPED_FILE &file, uint64_t from,
+                              vector<INDEX_RECORD> &records, uint64_t &end) {
+  const char *data = file.data, *last = file.data + file.length;
+
+  if (from == 0) {
+    const char *eol = mapLineEnd(data, last);
+    if (eol == last || string_view(data, eol - data) != beginSegment)
+      return (STRUCTURE);
+    from = eol - data + 1;
+  }
+
+  // the index keeps entries newest first, scan them in order of appearance
+  reverse(records.begin(), records.end());
+  map<string, size_t> ids;
+  for (size_t i = 0; i < records.size(); i++)
+    ids[string(records[i].ID, 8)] = i;
+
+  end = from;
+  while (end < file.length) {
+    const char *line = data + end, *eol = mapLineEnd(line, last);
+    if (eol == last)
+      break;
+
+    string header(line, eol - line);
+    char ID[9];
+    unsigned int version;
+    unsigned long long length;
+    if (header.compare(0, strlen(recordID), recordID) != 0 ||
+        sscanf(header.c_str() + strlen(recordID),
+               "%8s VERSION = %u LENGTH = %llu", ID, &version, &length) != 3)
+      break;
+
+    uint64_t offset = eol - data + 1;
+    if (length == 0 || offset + length > file.length ||
+        data[offset + length - 1] != '\n')
+      break;
+
+    applyRecord(records, ids, indexRecord(ID, offset, length, version));
+    end = offset + length;
+  }
+
+  reverse(records.begin(), records.end());
+
+  return (OK);
+}
+
+ERROR_CODE segmentCreate(const string &log) {
+  ofstream ofstr(log.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr << beginSegment << '\n';
+  ofstr.close();
+
+  return (ofstr.fail() ? IO_WRITE : OK);
+}
+
+ERROR_CODE segmentOpen(const MAPPED_FILE &file, LOG_INDEX &index) {
+  if (index.path == file.path + ".idx" && indexCurrent(index, file.f_stat))
+    return (OK);
+
+  if (indexLoad(file.path, INDEX_SEGMENT, index) == OK &&
+      indexCurrent(index, file.f_stat))
+    return (OK);
+
+  // an append-only segment that only grew needs just its tail scanned
+  vector<INDEX_RECORD> records;
+  uint64_t from = 0, end;
+  if (index.map != NULL &&
+      index.header->inode == static_cast<uint64_t>(file.f_stat.st_ino) &&
+      index.header->size <= file.length) {
+    indexRecords(index, records);
+    from = index.header->end;
+  }
+
+  ERROR_CODE state = scanSegment(file, from, records, end);
+  if (state != OK)
+    return (state);
+
+  return (indexWrite(index, file.path, INDEX_SEGMENT, file.f_stat, end,
+                     records));
+}
+
+ERROR_CODE segmentWrite(MAPPED_FILE &file, LOG_INDEX &index,
+                        const vector<SEGMENT_ENTRY> &entries) {
+  ERROR_CODE state = mapOpen(file.path, file);
+  if (state == OK)
+    state = segmentOpen(file, index);
+  if (state != OK)
+    return (state);
+
+  int fd = open(file.path.c_str(), O_WRONLY);
+  if (fd < 0)
+    return (IO_WRITE);
+
+  // drop a torn record left behind by an interrupted append
+  uint64_t end = index.header->end;
+  if (index.header->size != end && ftruncate(fd, end) != 0) {
+    close(fd);
+    return (IO_WRITE);
+  }
+
+  vector<INDEX_RECORD> records;
+  indexRecords(index, records);
+
+  reverse(records.begin(), records.end());
+  map<string, size_t> ids;
+  for (size_t i = 0; i < records.size(); i++)
+    ids[string(records[i].ID, 8)] = i;
+
+  string data;
+  for (size_t i = 0; i < entries.size(); i++) {
+    INDEX_RECORD record = indexRecord(entries[i].first, 0,
+                                      entries[i].second.length() + 1, 1);
+    map<string, size_t>::iterator it = ids.find(string(record.ID, 8));
+    if (it != ids.end())
+      record.version = records[it->second].version + 1;
+
+    string header =
+        recordHeader(entries[i].first, record.version, record.length);
+    record.offset = end + data.length() + header.length();
+    data += header + entries[i].second + '\n';
+    applyRecord(records, ids, record);
+  }
+
+  reverse(records.begin(), records.end());
+
+  if (lseek(fd, end, SEEK_SET) < 0 ||
+      write(fd, data.data(), data.length()) !=
+          static_cast<ssize_t>(data.length())) {
+    close(fd);
+    return (IO_WRITE);
+  }
+  close(fd);
+
+  state = mapOpen(file.path, file);
+  if (state == OK)
+    state = indexWrite(index, file.path, INDEX_SEGMENT, file.f_stat,
+                       end + data.length(), records);
+  if (state != OK)
+    return (state);
+
+  uint64_t live = strlen(beginSegment) + 1;
+  for (size_t i = 0; i < records.size(); i++)
+    live += recordHeader(string(records[i].ID, 8), records[i].version,
+                         records[i].length)
+                .length() +
+            records[i].length;
+
+  if (file.length > static_cast<uint64_t>(compactSize) &&
+      2 * live < file.length)
+    return (segmentCompact(file, index));
+
+  return (OK);
+}
+
+ERROR_CODE segmentCompact(MAPPED_FILE &file, LOG_INDEX &index) {
+  ERROR_CODE state = mapOpen(file.path, file);
+  if (state == OK)
+    state = segmentOpen(file, index);
+  if (state != OK)
+    return (state);
+
+  string tmp = file.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  vector<INDEX_RECORD> records;
+  indexRecords(index, records);
+
+  ofstr << beginSegment << '\n';
+  uint64_t end = strlen(beginSegment) + 1;
+
+  for (size_t i = records.size(); i-- > 0;) {
+    if (records[i].offset + records[i].length > file.length) {
+      ofstr.close();
+      unlink(tmp.c_str());
+      return (STRUCTURE);
+    }
+
+    string header = recordHeader(string(records[i].ID, 8), records[i].version,
+                                 records[i].length);
+    ofstr << header;
+    ofstr.write(file.data + records[i].offset, records[i].length);
+    records[i].offset = end + header.length();
+    end = records[i].offset + records[i].length;
+  }
+
+  ofstr.close();
+  if (ofstr.fail() || chmod(tmp.c_str(), file.f_stat.st_mode & 07777) != 0 ||
+      rename(tmp.c_str(), file.path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return (IO_WRITE);
+  }
+
+  state = mapOpen(file.path, file);
+  if (state != OK)
+    return (state);
+
+  return (indexWrite(index, file.path, INDEX_SEGMENT, file.f_stat, end,
+                     records));
+}
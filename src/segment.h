@@ -0,0 +1,31 @@
+/**
+ *  @file   segment.h
+ *  @brief  Append-only log segment storage
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef SEGMENT_H_
+#define SEGMENT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "index.h"
+#include "logger.h"
+#include "mapped.h"
+
+using namespace std;
+
+typedef pair<string, string> SEGMENT_ENTRY;
+
+ERROR_CODE segmentCreate(const string &log);
+ERROR_CODE segmentOpen(const MAPPED_FILE &file, LOG_INDEX &index);
+ERROR_CODE segmentWrite(MAPPED_FILE &file, LOG_INDEX &index,
+                        const vector<SEGMENT_ENTRY> &entries);
+ERROR_CODE segmentCompact(MAPPED_FILE &file, LOG_INDEX &index);
+
+#endif // SEGMENT_H_
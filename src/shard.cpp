@@ -0,0 +1,120 @@
+/**
+ *  @file   shard.cpp
+ *  @brief  Manifest of a log kept in a file per month
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "shard.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "days.h"
+
+const char *beginManifest = "<!--- BEGIN MANIFEST >";
+
+// shards are listed newest first, the undated one last
+static bool newer(const SHARD_INFO &a, const SHARD_INFO &b) {
+  return (a.first > b.first);
+}
+
+// YYYY-MM for the month of the entry
+string shardName(const string &ID) {
+  string day = dayID(dayKey(ID));
+  if (day.empty())
+    return (SHARD_UNDATED);
+
+  return (day.substr(4, 4) + "-" + day.substr(2, 2));
+}
+
+// the days of the month in the shard are those from first up to next
+SHARD_INFO shardInfo(const string &name, long count) {
+  SHARD_INFO shard = {name, count, 0, 0};
+  if (name.length() != 7 || name[4] != '-')
+    return (shard);
+
+  int year = atoi(name.substr(0, 4).c_str()),
+      month = atoi(name.substr(5, 2).c_str());
+  char first[16], next[16];
+  snprintf(first, sizeof(first), "01%02d%04d", month, year);
+  snprintf(next, sizeof(next), "01%02d%04d", month % 12 + 1,
+           year + (month == 12));
+  shard.first = dayKey(first);
+  shard.next = dayKey(next);
+
+  return (shard);
+}
+
+string shardManifest(const string &log) { return (log + "/manifest"); }
+
+string shardPath(const string &log, const string &name) {
+  return (log + "/" + name + ".dat");
+}
+
+ERROR_CODE shardCreate(const string &log) {
+  if (mkdir(log.c_str(), 0755) != 0 && errno != EEXIST)
+    return (IO_WRITE);
+
+  if (access(shardManifest(log).c_str(), F_OK) == 0)
+    return (OK);
+
+  return (shardWrite(log, vector<SHARD_INFO>()));
+}
+
+// a line per shard with its name and the number of entries it had when
+// the manifest was written
+ERROR_CODE shardRead(const MAPPED_FILE &manifest, vector<SHARD_INFO> &shards) {
+  string_view data(manifest.data, manifest.length);
+  size_t at = data.find('\n');
+  if (at == string_view::npos || data.substr(0, at) != beginManifest)
+    return (STRUCTURE);
+
+  shards.clear();
+  for (size_t end; ++at < data.length(); at = end) {
+    if ((end = data.find('\n', at)) == string_view::npos)
+      return (STRUCTURE);
+
+    string_view line = data.substr(at, end - at);
+    size_t space = line.find(' ');
+    if (space == string_view::npos)
+      return (STRUCTURE);
+
+    SHARD_INFO shard = shardInfo(string(line.substr(0, space)),
+                                 atol(string(line.substr(space + 1)).c_str()));
+    if (shard.first == 0 && shard.name != SHARD_UNDATED)
+      return (STRUCTURE);
+    shards.push_back(shard);
+  }
+  stable_sort(shards.begin(), shards.end(), newer);
+
+  return (OK);
+}
+
+// the manifest is replaced as a whole, readers keep the one they mapped
+ERROR_CODE shardWrite(const string &log, const vector<SHARD_INFO> &shards) {
+  string path = shardManifest(log), tmp = path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr << beginManifest << '\n';
+  for (size_t i = 0; i < shards.size(); i++)
+    ofstr << shards[i].name << ' ' << shards[i].count << '\n';
+  ofstr.close();
+
+  if (ofstr.fail() || rename(tmp.c_str(), path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return (IO_WRITE);
+  }
+
+  return (OK);
+}
@@ -0,0 +1,42 @@
+/**
+ *  @file   shard.h
+ *  @brief  Manifest of a log kept in a file per month
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef SHARD_H_
+#define SHARD_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "logger.h"
+#include "mapped.h"
+
+using namespace std;
+
+// the shard of the entries whose ID is not a date
+#define SHARD_UNDATED "undated"
+
+typedef struct {
+  string name;
+  long count;
+  uint32_t first;
+  uint32_t next;
+} SHARD_INFO;
+
+string shardName(const string &ID);
+SHARD_INFO shardInfo(const string &name, long count = 0);
+string shardManifest(const string &log);
+string shardPath(const string &log, const string &name);
+
+ERROR_CODE shardCreate(const string &log);
+ERROR_CODE shardRead(const MAPPED_FILE &manifest, vector<SHARD_INFO> &shards);
+ERROR_CODE shardWrite(const string &log, const vector<SHARD_INFO> &shards);
+
+#endif // SHARD_H_
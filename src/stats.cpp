@@ -0,0 +1,204 @@
+/**
+ *  @file   stats.cpp
+ *  @brief  Per-request phase timers and counters
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// in the order of STATS_PHASE and STATS_COUNTER
+const char *const statsPhaseNames[STATS_PHASES] = {
+    "request", "config", "open", "search", "render", "compress", "save",
+    "write"};
+const char *const statsCounterNames[STATS_COUNTERS] = {
+    "read", "lines", "entries", "written", "hits", "misses"};
+
+typedef struct {
+  char magic[8];
+  uint32_t size;
+  uint32_t reserved;
+} STATS_HEADER;
+
+static uint64_t elapsed[STATS_PHASES];
+static uint64_t counts[STATS_COUNTERS];
+static uint64_t mark = 0;
+static STATS_PHASE current = STATS_REQUEST;
+
+static uint64_t now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec);
+}
+
+void statsBegin(void) {
+  memset(elapsed, 0, sizeof(elapsed));
+  memset(counts, 0, sizeof(counts));
+  current = STATS_REQUEST;
+  mark = now();
+}
+
+// The time since the last switch goes to the phase that was running, so
+// a request costs one clock read per switch. Returns that phase, which
+// lets a caller hand the time back when it is done.
+STATS_PHASE statsPhase(STATS_PHASE phase) {
+  uint64_t t = now();
+  elapsed[current] += t - mark;
+  mark = t;
+
+  STATS_PHASE previous = current;
+  current = phase;
+  return (previous);
+}
+
+void statsCount(STATS_COUNTER counter, uint64_t amount) {
+  counts[counter] += amount;
+}
+
+// The value of a Server-Timing header, durations in milliseconds. The
+// head goes out before the body, so the bytes written are never in it,
+// nor the other counters while the page is not complete yet, the timings
+// are then marked partial. The stats file gets them all.
+string statsTiming(bool complete) {
+  statsPhase(current);
+
+  string timing;
+  char metric[64];
+  uint64_t total = 0;
+  for (int phase = 0; phase < STATS_PHASES; phase++) {
+    total += elapsed[phase];
+    if (elapsed[phase] == 0)
+      continue;
+    snprintf(metric, sizeof(metric), "%s;dur=%.3f, ", statsPhaseNames[phase],
+             elapsed[phase] / 1e6);
+    timing += metric;
+  }
+  snprintf(metric, sizeof(metric), "total;dur=%.3f", total / 1e6);
+  timing += metric;
+
+  if (!complete)
+    return (timing + ", partial");
+
+  for (int counter = 0; counter < STATS_COUNTERS; counter++) {
+    if (counter == STATS_BYTES_WRITTEN)
+      continue;
+    snprintf(metric, sizeof(metric), ", %s;desc=%llu",
+             statsCounterNames[counter],
+             static_cast<unsigned long long>(counts[counter]));
+    timing += metric;
+  }
+
+  return (timing);
+}
+
+// a new file gets its header before it appears, so appends never race it
+static bool statsCreate(const string &file) {
+  string tmp = file + ".tmp." + to_string(getpid());
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return (false);
+
+  STATS_HEADER header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, STATS_MAGIC, sizeof(header.magic));
+  header.size = sizeof(STATS_RECORD);
+  bool written = write(fd, &header, sizeof(header)) == sizeof(header);
+  close(fd);
+
+  // another process may have created it first, which is just as good
+  if (written && link(tmp.c_str(), file.c_str()) != 0 && errno != EEXIST)
+    written = false;
+  unlink(tmp.c_str());
+
+  return (written);
+}
+
+// Appends the request to file, which is moved to file.1 once it holds
+// STATS_LIMIT bytes. Records are written with a single append, so
+// concurrent requests do not interleave.
+ERROR_CODE statsEnd(const string &file, const string &action,
+                    ERROR_CODE state) {
+  statsPhase(current);
+  if (file.empty())
+    return (OK);
+
+  STATS_RECORD record;
+  memset(&record, 0, sizeof(record));
+  record.time = time(NULL);
+  strncpy(record.action, action.c_str(), sizeof(record.action) - 1);
+  record.state = state;
+  for (int phase = 0; phase < STATS_PHASES; phase++)
+    record.phases[phase] = elapsed[phase] / 1000;
+  for (int counter = 0; counter < STATS_COUNTERS; counter++)
+    record.counters[counter] = counts[counter];
+
+  struct stat f_stat;
+  if (stat(file.c_str(), &f_stat) == 0 && f_stat.st_size >= STATS_LIMIT)
+    rename(file.c_str(), (file + ".1").c_str());
+  if (access(file.c_str(), F_OK) != 0 && !statsCreate(file))
+    return (IO_WRITE);
+
+  int fd = open(file.c_str(), O_RDWR | O_APPEND);
+  if (fd < 0)
+    return (IO_WRITE);
+
+  // a file of records laid out differently is rotated out of the way
+  STATS_HEADER header;
+  if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      memcmp(header.magic, STATS_MAGIC, sizeof(header.magic)) != 0 ||
+      header.size != sizeof(STATS_RECORD)) {
+    close(fd);
+    rename(file.c_str(), (file + ".1").c_str());
+    if (!statsCreate(file) ||
+        (fd = open(file.c_str(), O_WRONLY | O_APPEND)) < 0)
+      return (IO_WRITE);
+  }
+
+  bool written = write(fd, &record, sizeof(record)) == sizeof(record);
+  close(fd);
+
+  return (written ? OK : IO_WRITE);
+}
+
+static ERROR_CODE statsLoad(const string &file,
+                            vector<STATS_RECORD> &records) {
+  ifstream ifstr(file.c_str(), ios::in | ios::binary);
+  if (ifstr.fail())
+    return (NOT_FOUND);
+
+  STATS_HEADER header;
+  if (!ifstr.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      memcmp(header.magic, STATS_MAGIC, sizeof(header.magic)) != 0 ||
+      header.size != sizeof(STATS_RECORD))
+    return (STRUCTURE);
+
+  STATS_RECORD record;
+  while (ifstr.read(reinterpret_cast<char *>(&record), sizeof(record)))
+    records.push_back(record);
+
+  return (OK);
+}
+
+// the rotated file first, so the records stay in the order they came in
+ERROR_CODE statsRead(const string &file, vector<STATS_RECORD> &records) {
+  records.clear();
+
+  ERROR_CODE rotated = statsLoad(file + ".1", records),
+             state = statsLoad(file, records);
+  if (state == NOT_FOUND && rotated == OK)
+    return (OK);
+
+  return (state);
+}
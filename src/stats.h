@@ -0,0 +1,67 @@
+/**
+ *  @file   stats.h
+ *  @brief  Per-request phase timers and counters
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+#define STATS_MAGIC "BOLSTAT1"
+#define STATS_LIMIT 1048576
+
+typedef enum {
+  STATS_REQUEST,
+  STATS_CONFIG,
+  STATS_OPEN,
+  STATS_SEARCH,
+  STATS_RENDER,
+  STATS_COMPRESS,
+  STATS_SAVE,
+  STATS_WRITE,
+  STATS_PHASES
+} STATS_PHASE;
+
+typedef enum {
+  STATS_BYTES_READ,
+  STATS_LINES,
+  STATS_ENTRIES,
+  STATS_BYTES_WRITTEN,
+  STATS_HITS,
+  STATS_MISSES,
+  STATS_COUNTERS
+} STATS_COUNTER;
+
+typedef struct {
+  int64_t time;
+  char action[16];
+  int32_t state;
+  uint32_t phases[STATS_PHASES];
+  uint64_t counters[STATS_COUNTERS];
+} STATS_RECORD;
+
+extern const char *const statsPhaseNames[STATS_PHASES];
+extern const char *const statsCounterNames[STATS_COUNTERS];
+
+void statsBegin(void);
+STATS_PHASE statsPhase(STATS_PHASE phase);
+void statsCount(STATS_COUNTER counter, uint64_t amount);
+string statsTiming(bool complete);
+
+ERROR_CODE statsEnd(const string &file, const string &action,
+                    ERROR_CODE state);
+ERROR_CODE statsRead(const string &file, vector<STATS_RECORD> &records);
+
+#endif // STATS_H_
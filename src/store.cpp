@@ -0,0 +1,839 @@
+/**
+ *  @file   store.cpp
+ *  @brief  Entry storage
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "index.h"
+#include "mapped.h"
+#include "segment.h"
+#include "shard.h"
+#include "stats.h"
+
+// a position in a sharded log has its shard above the position in it
+#define STORE_SHARD_SHIFT 32
+
+// a month of a sharded log, mapped when it is first needed and checked
+// again after the manifest changed
+typedef struct {
+  SHARD_INFO info;
+  bool open;
+  MAPPED_FILE file;
+  LOG_INDEX index;
+} STORE_SHARD;
+
+static bool segmented = false, sharded = false;
+// the log, or the manifest of a sharded one
+static MAPPED_FILE storeMap;
+static LOG_INDEX storeIndex;
+static WORDS_INDEX storeWords;
+static GRAMS_INDEX storeGrams;
+static string storeDirectory;
+static vector<STORE_SHARD> storeShards;
+static const char *storeListed = NULL;
+
+static void textEntry(ostream &out, const string &ID, string_view content) {
+  out << "  " << entryID << ID << " >\n"
+      << "    " << contentID << ID << " >\n"
+      << content << endContent << "\n\n";
+}
+
+static ERROR_CODE textScan(const MAPPED_FILE &file,
+                           vector<INDEX_RECORD> &records) {
+  const char *data = file.data, *last = file.data + file.length, *at = data;
+
+  while ((at = mapFind(at, last, contentID)) != NULL) {
+    const char *line = mapLineStart(data, at), *eol = mapLineEnd(at, last);
+    if (eol == last)
+      return (STRUCTURE);
+
+    string_view header(line, eol - line);
+    string ID(header.substr(header.find_first_of("=") + 2, 8));
+
+    const char *begin = eol + 1, *end = mapFind(begin, last, endContent);
+    if (end == NULL)
+      return (STRUCTURE);
+    end = mapLineStart(begin, end);
+
+    records.push_back(indexRecord(ID, begin - data, end - begin));
+    at = mapLineEnd(end, last);
+  }
+
+  return (OK);
+}
+
+static ERROR_CODE textOpen(const MAPPED_FILE &file, LOG_INDEX &index) {
+  if (index.path == file.path + ".idx" && indexCurrent(index, file.f_stat))
+    return (OK);
+
+  if (indexLoad(file.path, INDEX_TEXT, index) == OK &&
+      indexCurrent(index, file.f_stat))
+    return (OK);
+
+  vector<INDEX_RECORD> records;
+  ERROR_CODE state = textScan(file, records);
+  if (state != OK)
+    return (state);
+
+  return (indexWrite(index, file.path, INDEX_TEXT, file.f_stat, file.length,
+                     records));
+}
+
+// puts the new log written to tmp in place of file, readers keep their
+// mapping of the previous one
+static ERROR_CODE textReplace(const MAPPED_FILE &file, const string &tmp,
+                              ofstream &ofstr) {
+  ofstr.close();
+
+  if (ofstr.fail() || chmod(tmp.c_str(), file.f_stat.st_mode & 07777) != 0 ||
+      rename(tmp.c_str(), file.path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return (IO_WRITE);
+  }
+
+  return (OK);
+}
+
+static ERROR_CODE textWrite(MAPPED_FILE &file, LOG_INDEX &index,
+                            const string &ID, const string &content) {
+  ERROR_CODE state = mapOpen(file.path, file);
+  if (state == OK)
+    state = textOpen(file, index);
+  if (state != OK)
+    return (state);
+
+  vector<INDEX_RECORD> records;
+  indexRecords(index, records);
+
+  // splice the content into the log; a new entry goes right after the
+  // entries marker so the log stays ordered newest first
+  long pos = indexFind(index, ID);
+  string block;
+  size_t at, erase;
+  uint64_t offset, length = content.length() + 1;
+  if (pos >= 0) {
+    at = records[pos].offset;
+    erase = records[pos].length;
+    offset = at;
+    block = content + '\n';
+  } else {
+    const char *last = file.data + file.length,
+               *marker = mapFind(file.data, last, entries);
+    if (marker == NULL || mapLineEnd(marker, last) == last)
+      return (STRUCTURE);
+    at = mapLineEnd(marker, last) - file.data + 1;
+    erase = 0;
+    block = string("  ") + entryID + ID + " >\n" + "    " + contentID + ID +
+            " >\n";
+    offset = at + block.length();
+    block += content + '\n' + endContent + "\n\n";
+  }
+
+  string tmp = file.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr.write(file.data, at);
+  ofstr << block;
+  ofstr.write(file.data + at + erase, file.length - at - erase);
+  if (textReplace(file, tmp, ofstr) != OK)
+    return (IO_WRITE);
+
+  int64_t shift = static_cast<int64_t>(block.length()) - erase;
+  for (size_t i = 0; i < records.size(); i++)
+    if (records[i].offset > at)
+      records[i].offset += shift;
+
+  if (pos >= 0)
+    records[pos].length = length;
+  else
+    records.insert(records.begin(), indexRecord(ID, offset, length));
+
+  state = mapOpen(file.path, file);
+  if (state != OK)
+    return (state);
+
+  return (indexWrite(index, file.path, INDEX_TEXT, file.f_stat, file.length,
+                     records));
+}
+
+// Merges entries, oldest first, into the log in a single rewrite with the
+// outcome of saving them one by one: an entry already in the log keeps its
+// place and gets the last text given for it, the new ones go right after
+// the entries marker, newest first.
+static ERROR_CODE textImport(MAPPED_FILE &file, LOG_INDEX &index,
+                             const vector<SEGMENT_ENTRY> &batch) {
+  ERROR_CODE state = mapOpen(file.path, file);
+  if (state == OK)
+    state = textOpen(file, index);
+  if (state != OK)
+    return (state);
+
+  map<string, size_t> latest;
+  vector<size_t> added;
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (latest.count(batch[i].first) == 0 &&
+        indexFind(index, batch[i].first) < 0)
+      added.push_back(i);
+    latest[batch[i].first] = i;
+  }
+
+  const char *last = file.data + file.length,
+             *marker = mapFind(file.data, last, entries);
+  if (marker == NULL || mapLineEnd(marker, last) == last)
+    return (STRUCTURE);
+  size_t at = mapLineEnd(marker, last) - file.data + 1;
+
+  string tmp = file.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr.write(file.data, at);
+  for (size_t i = added.size(); i-- > 0;) {
+    const SEGMENT_ENTRY &entry = batch[latest[batch[added[i]].first]];
+    textEntry(ofstr, entry.first, entry.second + '\n');
+  }
+
+  // the records are in the order of the log
+  vector<INDEX_RECORD> records;
+  indexRecords(index, records);
+  for (size_t i = 0; i < records.size(); i++) {
+    map<string, size_t>::iterator found =
+        latest.find(string(records[i].ID, 8));
+    if (found == latest.end())
+      continue;
+
+    ofstr.write(file.data + at, records[i].offset - at);
+    ofstr << batch[found->second].second << '\n';
+    at = records[i].offset + records[i].length;
+  }
+  ofstr.write(file.data + at, file.length - at);
+  if (textReplace(file, tmp, ofstr) != OK)
+    return (IO_WRITE);
+
+  state = mapOpen(file.path, file);
+  if (state == OK)
+    state = textOpen(file, index);
+
+  return (state);
+}
+
+static long shardPosition(size_t s, long pos) {
+  return (pos < 0 ? -1 : static_cast<long>(s) << STORE_SHARD_SHIFT | pos);
+}
+
+static bool newerShard(const STORE_SHARD &a, const STORE_SHARD &b) {
+  return (a.info.first > b.info.first);
+}
+
+static long shardFind(const string &name) {
+  for (size_t s = 0; s < storeShards.size(); s++)
+    if (storeShards[s].info.name == name)
+      return (s);
+
+  return (-1);
+}
+
+// Lists the shards of the manifest in storeMap. A remapped manifest has
+// a new address, the shards already mapped are then kept but checked again
+// before their next use, the others are closed.
+static ERROR_CODE shardsList(void) {
+  if (storeListed == storeMap.data)
+    return (OK);
+
+  vector<SHARD_INFO> infos;
+  ERROR_CODE state = shardRead(storeMap, infos);
+  if (state != OK)
+    return (state);
+
+  map<string, size_t> mapped;
+  for (size_t s = 0; s < storeShards.size(); s++)
+    mapped[storeShards[s].info.name] = s;
+
+  vector<STORE_SHARD> shards(infos.size());
+  for (size_t s = 0; s < infos.size(); s++) {
+    shards[s].info = infos[s];
+    map<string, size_t>::iterator found = mapped.find(infos[s].name);
+    if (found != mapped.end()) {
+      shards[s].file = storeShards[found->second].file;
+      shards[s].index = storeShards[found->second].index;
+      mapped.erase(found);
+    }
+  }
+
+  for (map<string, size_t>::iterator i = mapped.begin(); i != mapped.end();
+       i++) {
+    mapClose(storeShards[i->second].file);
+    indexClose(storeShards[i->second].index);
+  }
+  storeShards.swap(shards);
+  storeListed = storeMap.data;
+
+  return (OK);
+}
+
+static ERROR_CODE shardOpen(size_t s) {
+  STORE_SHARD &shard = storeShards[s];
+  if (shard.open)
+    return (OK);
+
+  ERROR_CODE state =
+      mapOpen(shardPath(storeDirectory, shard.info.name), shard.file);
+  if (state == OK)
+    state = textOpen(shard.file, shard.index);
+  shard.open = state == OK;
+
+  return (state);
+}
+
+// a shard for a month the manifest does not list yet, with an empty log
+// unless one was left behind by a save that did not get to the manifest
+static long shardAdd(const string &name) {
+  string path = shardPath(storeDirectory, name);
+  if (access(path.c_str(), F_OK) != 0 && storeCreate(path, "text") != OK)
+    return (-1);
+
+  STORE_SHARD shard = STORE_SHARD();
+  shard.info = shardInfo(name);
+  long s = upper_bound(storeShards.begin(), storeShards.end(), shard,
+                       newerShard) -
+           storeShards.begin();
+  storeShards.insert(storeShards.begin() + s, shard);
+
+  return (s);
+}
+
+// writes the manifest with the number of entries of every shard as far as
+// they are known and maps it
+static ERROR_CODE shardsWrite(void) {
+  vector<SHARD_INFO> infos;
+  for (size_t s = 0; s < storeShards.size(); s++) {
+    infos.push_back(storeShards[s].info);
+    if (storeShards[s].open)
+      infos.back().count = indexCount(storeShards[s].index);
+  }
+
+  ERROR_CODE state = shardWrite(storeDirectory, infos);
+  if (state == OK)
+    state = mapOpen(shardManifest(storeDirectory), storeMap);
+  if (state == OK)
+    state = shardsList();
+
+  return (state);
+}
+
+// a save only rewrites the shard of the month of the entry, and the
+// manifest after it
+static ERROR_CODE shardSave(const string &ID, const string &content) {
+  string name = shardName(ID);
+  long s = shardFind(name);
+  if (s < 0 && (s = shardAdd(name)) < 0)
+    return (IO_WRITE);
+
+  ERROR_CODE state = shardOpen(s);
+  if (state == OK)
+    state = textWrite(storeShards[s].file, storeShards[s].index, ID, content);
+  if (state == OK)
+    state = shardsWrite();
+
+  return (state);
+}
+
+// the entry a day before or after pos, in its own month or in the nearest
+// one in that direction that has entries
+static long shardStep(long pos, long step) {
+  size_t s = pos >> STORE_SHARD_SHIFT;
+  if (pos < 0 || s >= storeShards.size() || !storeShards[s].open)
+    return (-1);
+
+  long at = pos & ((1L << STORE_SHARD_SHIFT) - 1),
+       next = indexNeighbour(storeShards[s].index, at, step);
+  if (next >= 0 || indexKey(storeShards[s].index, at) == 0)
+    return (shardPosition(s, next));
+
+  // newer months come first in the manifest
+  for (long t = s - step; t >= 0 && t < static_cast<long>(storeShards.size());
+       t -= step) {
+    if (storeShards[t].info.first == 0)
+      continue;
+    if (shardOpen(t) != OK)
+      return (-1);
+
+    long edge = indexEdge(storeShards[t].index, step < 0);
+    if (edge >= 0)
+      return (shardPosition(t, edge));
+  }
+
+  return (-1);
+}
+
+static bool storeLocate(long pos, const MAPPED_FILE *&file,
+                        const LOG_INDEX *&index, long &at) {
+  if (pos < 0)
+    return (false);
+
+  if (!sharded) {
+    file = &storeMap;
+    index = &storeIndex;
+    at = pos;
+    return (true);
+  }
+
+  size_t s = pos >> STORE_SHARD_SHIFT;
+  if (s >= storeShards.size() || !storeShards[s].open)
+    return (false);
+
+  file = &storeShards[s].file;
+  index = &storeShards[s].index;
+  at = pos & ((1L << STORE_SHARD_SHIFT) - 1);
+
+  return (true);
+}
+
+ERROR_CODE storeOpen(const string &log, const string &storage) {
+  segmented = storage == "segment";
+  sharded = storage == "sharded";
+
+  if (sharded) {
+    storeDirectory = log;
+    ERROR_CODE state = mapOpen(shardManifest(log), storeMap);
+    return (state == OK ? shardsList() : state);
+  }
+
+  ERROR_CODE state = mapOpen(log, storeMap);
+  if (state != OK)
+    return (state);
+
+  if (segmented)
+    return (segmentOpen(storeMap, storeIndex));
+
+  return (textOpen(storeMap, storeIndex));
+}
+
+ERROR_CODE storeCreate(const string &log, const string &storage) {
+  if (storage == "segment")
+    return (segmentCreate(log));
+  if (storage == "sharded")
+    return (shardCreate(log));
+
+  ofstream ofstr(log.c_str(), ios::out);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr << entries << endl << endEntries;
+  ofstr.close();
+
+  return (OK);
+}
+
+// the open log as last seen, every save gives it a new size or inode and
+// modification time; for a sharded log that is its manifest
+const struct stat &storeStat(void) { return (storeMap.f_stat); }
+
+long storeFind(const string &ID) {
+  if (!sharded)
+    return (indexFind(storeIndex, ID));
+
+  long s = shardFind(shardName(ID));
+  if (s < 0 || shardOpen(s) != OK)
+    return (-1);
+
+  return (shardPosition(s, indexFind(storeShards[s].index, ID)));
+}
+
+long storeCount(void) {
+  if (!sharded)
+    return (indexCount(storeIndex));
+
+  long count = 0;
+  for (size_t s = 0; s < storeShards.size(); s++)
+    count += storeShards[s].open ? indexCount(storeShards[s].index)
+                                 : storeShards[s].info.count;
+
+  return (count);
+}
+
+// every position in the order of the log, a sharded one month by month
+ERROR_CODE storeAll(vector<long> &positions) {
+  for (long pos = 0; !sharded && pos < indexCount(storeIndex); pos++)
+    positions.push_back(pos);
+
+  for (size_t s = 0; sharded && s < storeShards.size(); s++) {
+    ERROR_CODE state = shardOpen(s);
+    if (state != OK)
+      return (state);
+
+    for (long pos = 0; pos < indexCount(storeShards[s].index); pos++)
+      positions.push_back(shardPosition(s, pos));
+  }
+
+  return (OK);
+}
+
+string storeID(long pos) {
+  const MAPPED_FILE *file;
+  const LOG_INDEX *index;
+  long at;
+  if (!storeLocate(pos, file, index, at))
+    return ("");
+
+  return (indexID(*index, at));
+}
+
+uint32_t storeKey(long pos) {
+  const MAPPED_FILE *file;
+  const LOG_INDEX *index;
+  long at;
+  if (!storeLocate(pos, file, index, at))
+    return (0);
+
+  return (indexKey(*index, at));
+}
+
+long storeNeighbour(long pos, long step) {
+  if (!sharded)
+    return (indexNeighbour(storeIndex, pos, step));
+
+  for (long one = step < 0 ? -1 : 1; pos >= 0 && step != 0; step -= one)
+    pos = shardStep(pos, one);
+
+  return (pos);
+}
+
+// only the shards of the months in the range are opened
+void storeRange(uint32_t from, uint32_t to, vector<long> &positions) {
+  if (!sharded) {
+    indexRange(storeIndex, from, to, positions);
+    return;
+  }
+
+  vector<long> found;
+  for (size_t s = 0; s < storeShards.size(); s++) {
+    const SHARD_INFO &info = storeShards[s].info;
+    if (info.first == 0 || info.next <= from || info.first > to ||
+        shardOpen(s) != OK)
+      continue;
+
+    found.clear();
+    indexRange(storeShards[s].index, from, to, found);
+    for (size_t i = 0; i < found.size(); i++)
+      positions.push_back(shardPosition(s, found[i]));
+  }
+}
+
+// the months are visited newest first going older, oldest first going
+// newer, until the page is full
+void storePage(uint32_t key, bool older, size_t limit,
+               vector<long> &positions) {
+  if (!sharded) {
+    indexPage(storeIndex, key, older, limit, positions);
+    return;
+  }
+
+  vector<long> found;
+  for (size_t i = 0; i < storeShards.size() && positions.size() < limit;
+       i++) {
+    size_t s = older ? i : storeShards.size() - 1 - i;
+    const SHARD_INFO &info = storeShards[s].info;
+    if (info.first == 0 || (older ? info.first >= key : info.next <= key + 1) ||
+        shardOpen(s) != OK)
+      continue;
+
+    found.clear();
+    indexPage(storeShards[s].index, key, older, limit - positions.size(),
+              found);
+    for (size_t i = 0; i < found.size(); i++)
+      positions.push_back(shardPosition(s, found[i]));
+  }
+}
+
+ERROR_CODE storeRead(long pos, string_view &content) {
+  const MAPPED_FILE *file;
+  const LOG_INDEX *index;
+  long at;
+  if (!storeLocate(pos, file, index, at) || at >= indexCount(*index))
+    return (NOT_FOUND);
+
+  const INDEX_RECORD &record = index->records[at];
+  if (record.offset + record.length > file->length)
+    return (STRUCTURE);
+
+  content = string_view(file->data + record.offset, record.length);
+  statsCount(STATS_ENTRIES, 1);
+  statsCount(STATS_BYTES_READ, record.length);
+
+  return (OK);
+}
+
+static ERROR_CODE storeEntries(vector<pair<string, string_view>> &entries) {
+  vector<long> positions;
+  ERROR_CODE state = storeAll(positions);
+
+  string_view content;
+  for (size_t i = 0; state == OK && i < positions.size(); i++)
+    if ((state = storeRead(positions[i], content)) == OK)
+      entries.push_back(make_pair(storeID(positions[i]), content));
+
+  return (state);
+}
+
+// the search indices are loaded lazily by the first search that needs them
+static bool wordsOpen(void) {
+  if (storeWords.path != storeMap.path + ".words" ||
+      !wordsCurrent(storeWords, storeMap.f_stat))
+    wordsLoad(storeMap.path, storeWords);
+
+  return (wordsCurrent(storeWords, storeMap.f_stat));
+}
+
+static bool gramsOpen(void) {
+  if (storeGrams.path != storeMap.path + ".grams" ||
+      !gramsCurrent(storeGrams, storeMap.f_stat))
+    gramsLoad(storeMap.path, storeGrams);
+
+  return (gramsCurrent(storeGrams, storeMap.f_stat));
+}
+
+ERROR_CODE storeCandidates(const string &match, vector<long> &positions) {
+  if (!gramsOpen()) {
+    vector<GRAMS_ENTRY> entries;
+    ERROR_CODE state = storeEntries(entries);
+    if (state == OK)
+      state = gramsBuild(storeGrams, storeMap.path, storeMap.f_stat, entries);
+    if (state != OK)
+      return (state);
+  }
+
+  // without trigrams to go on every entry is a candidate
+  vector<string> IDs;
+  if (!gramsCandidates(storeGrams, match, IDs))
+    return (storeAll(positions));
+
+  for (size_t i = 0; i < IDs.size(); i++) {
+    long pos = storeFind(IDs[i]);
+    if (pos >= 0)
+      positions.push_back(pos);
+  }
+  sort(positions.begin(), positions.end());
+
+  return (OK);
+}
+
+ERROR_CODE storeRank(const string &query, size_t limit,
+                     vector<WORDS_HIT> &hits) {
+  if (!wordsOpen()) {
+    vector<WORDS_ENTRY> entries;
+    ERROR_CODE state = storeEntries(entries);
+    if (state == OK)
+      state = wordsBuild(storeWords, storeMap.path, storeMap.f_stat, entries);
+    if (state != OK)
+      return (state);
+  }
+
+  wordsRank(storeWords, query, limit, hits);
+
+  return (OK);
+}
+
+// Saves are serialized on an advisory lock on <log>.lock, or <manifest>.lock
+// when the log is sharded. The lock file is never replaced itself, while a
+// text save writes a new log and renames it into place and a segment save
+// appends past the end that earlier readers mapped. Readers never take the
+// lock and keep the mapping of the version they opened.
+static int storeLock(void) {
+  int fd = open((storeMap.path + ".lock").c_str(),
+                O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return (-1);
+
+  while (flock(fd, LOCK_EX) != 0)
+    if (errno != EINTR) {
+      close(fd);
+      return (-1);
+    }
+
+  return (fd);
+}
+
+// the log as the last save left it, and with it the entry being saved
+static ERROR_CODE storeLatest(void) {
+  ERROR_CODE state = mapOpen(storeMap.path, storeMap);
+  if (state != OK)
+    return (state);
+
+  if (sharded)
+    return (shardsList());
+
+  if (segmented)
+    return (segmentOpen(storeMap, storeIndex));
+
+  return (textOpen(storeMap, storeIndex));
+}
+
+static ERROR_CODE storeSave(const string &ID, const string &content) {
+  // search indices that are up to date only need the saved entry reindexed,
+  // stale ones are rebuilt by the next search
+  bool ranked = wordsOpen(), grams = gramsOpen();
+  string previous;
+  string_view old;
+  if ((ranked || grams) && storeRead(storeFind(ID), old) == OK)
+    previous = old;
+
+  ERROR_CODE state;
+  if (sharded)
+    state = shardSave(ID, content);
+  else if (segmented)
+    state = segmentWrite(storeMap, storeIndex,
+                         vector<SEGMENT_ENTRY>(1, SEGMENT_ENTRY(ID, content)));
+  else
+    state = textWrite(storeMap, storeIndex, ID, content);
+
+  // the stored entry ends in a newline
+  if (state == OK && ranked)
+    wordsUpdate(storeWords, storeMap.f_stat, ID, previous, content + '\n');
+  if (state == OK && grams)
+    gramsUpdate(storeGrams, storeMap.f_stat, ID, previous, content + '\n');
+
+  return (state);
+}
+
+ERROR_CODE storeWrite(const string &ID, const string &content) {
+  int lock = storeLock();
+  if (lock < 0)
+    return (IO_WRITE);
+
+  ERROR_CODE state = storeLatest();
+  if (state == OK)
+    state = storeSave(ID, content);
+  close(lock);
+
+  return (state);
+}
+
+ERROR_CODE storeCompact(void) {
+  if (!segmented)
+    return (OK);
+
+  int lock = storeLock();
+  if (lock < 0)
+    return (IO_WRITE);
+
+  ERROR_CODE state = segmentCompact(storeMap, storeIndex);
+  close(lock);
+
+  return (state);
+}
+
+// splits the entries, oldest first, into the shards of their months and
+// merges them into each in a single rewrite
+static ERROR_CODE shardImport(const vector<SEGMENT_ENTRY> &batch) {
+  map<string, vector<SEGMENT_ENTRY>> months;
+  for (size_t i = 0; i < batch.size(); i++)
+    months[shardName(batch[i].first)].push_back(batch[i]);
+
+  ERROR_CODE state = OK;
+  for (map<string, vector<SEGMENT_ENTRY>>::iterator month = months.begin();
+       state == OK && month != months.end(); month++) {
+    long s = shardFind(month->first);
+    if (s < 0 && (s = shardAdd(month->first)) < 0)
+      state = IO_WRITE;
+    if (state == OK)
+      state = shardOpen(s);
+    if (state == OK)
+      state = textImport(storeShards[s].file, storeShards[s].index,
+                         month->second);
+  }
+
+  if (state == OK)
+    state = shardsWrite();
+
+  return (state);
+}
+
+ERROR_CODE storeImport(const string &file) {
+  MAPPED_FILE imported = {};
+  ERROR_CODE state = mapOpen(file, imported);
+  if (state != OK)
+    return (state);
+
+  vector<INDEX_RECORD> records;
+  state = textScan(imported, records);
+
+  // the log lists entries newest first, import them oldest first
+  vector<SEGMENT_ENTRY> batch;
+  for (size_t i = records.size(); state == OK && i-- > 0;) {
+    if (records[i].offset + records[i].length > imported.length) {
+      state = STRUCTURE;
+      break;
+    }
+
+    string content(imported.data + records[i].offset, records[i].length);
+    if (!content.empty())
+      content.erase(content.length() - 1);
+
+    batch.push_back(SEGMENT_ENTRY(string(records[i].ID, 8), content));
+  }
+  mapClose(imported);
+
+  if (state != OK)
+    return (state);
+
+  int lock = storeLock();
+  if (lock < 0)
+    return (IO_WRITE);
+
+  if (sharded)
+    state = shardImport(batch);
+  else if (segmented)
+    state = segmentWrite(storeMap, storeIndex, batch);
+  else
+    state = textImport(storeMap, storeIndex, batch);
+  close(lock);
+
+  return (state);
+}
+
+ERROR_CODE storeExport(const string &file) {
+  ofstream ofstr(file.c_str(), ios::out | ios::binary);
+  if (ofstr.fail())
+    return (IO_WRITE);
+
+  ofstr << entries << '\n';
+
+  // a sharded log is joined back together newest month first
+  vector<long> positions;
+  ERROR_CODE state = storeAll(positions);
+  if (state != OK)
+    return (state);
+
+  string_view content;
+  for (size_t i = 0; i < positions.size(); i++) {
+    if ((state = storeRead(positions[i], content)) != OK)
+      return (state);
+
+    textEntry(ofstr, storeID(positions[i]), content);
+  }
+
+  ofstr << endEntries << '\n';
+  ofstr.close();
+
+  return (ofstr.fail() ? IO_WRITE : OK);
+}
@@ -0,0 +1,51 @@
+/**
+ *  @file   store.h
+ *  @brief  Entry storage
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef STORE_H_
+#define STORE_H_
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "grams.h"
+#include "logger.h"
+#include "words.h"
+
+using namespace std;
+
+ERROR_CODE storeOpen(const string &log, const string &storage);
+ERROR_CODE storeCreate(const string &log, const string &storage);
+
+const struct stat &storeStat(void);
+
+long storeFind(const string &ID);
+long storeCount(void);
+ERROR_CODE storeAll(vector<long> &positions);
+string storeID(long pos);
+uint32_t storeKey(long pos);
+long storeNeighbour(long pos, long step);
+void storeRange(uint32_t from, uint32_t to, vector<long> &positions);
+void storePage(uint32_t key, bool older, size_t limit,
+               vector<long> &positions);
+ERROR_CODE storeRead(long pos, string_view &content);
+ERROR_CODE storeCandidates(const string &match, vector<long> &positions);
+ERROR_CODE storeRank(const string &query, size_t limit,
+                     vector<WORDS_HIT> &hits);
+
+ERROR_CODE storeWrite(const string &ID, const string &content);
+ERROR_CODE storeCompact(void);
+
+ERROR_CODE storeImport(const string &file);
+ERROR_CODE storeExport(const string &file);
+
+#endif // STORE_H_
@@ -0,0 +1,339 @@
+/**
+ *  @file   template.cpp
+ *  @brief  Precompiled page templates
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "template.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "search.h"
+
+// in the order of TEMPLATE_SLOT
+static const char *const slotNames[TEMPLATE_SLOTS] = {
+    "self",      "base",         "plugin",   "scheme",       "administrator",
+    "pageSize",  "match",        "year",     "ID",           "date",
+    "content",   "navigation",   "previous", "previousDate", "next",
+    "nextDate",  "limit",        "newer",    "cursor",       "at",
+    "matched",   "query",        "code",     "message",      "log",
+    "logStatus", "pluginStatus", "themes",   "stats"};
+
+typedef struct {
+  TEMPLATE compiled;
+  bool valid;
+  struct stat f_stat;
+  unsigned checked;
+  const TEMPLATE *active;
+} THEME_PAGE;
+
+static TEMPLATE defaults[TEMPLATES];
+static bool defaultsCompiled = false;
+
+static THEME_PAGE themed[TEMPLATES];
+static string themeDirectory;
+static unsigned generation = 1;
+
+static int slotIndex(string_view name) {
+  for (int slot = 0; slot < TEMPLATE_SLOTS; slot++)
+    if (name == slotNames[slot])
+      return (slot);
+  return (-1);
+}
+
+static void escape(ostream &out, string_view value) {
+  size_t begin = 0;
+  for (size_t idx = 0; idx < value.length(); idx++) {
+    const char *entity;
+    switch (value[idx]) {
+    case '&':
+      entity = "&amp;";
+      break;
+    case '<':
+      entity = "&lt;";
+      break;
+    case '>':
+      entity = "&gt;";
+      break;
+    case '"':
+      entity = "&quot;";
+      break;
+    case '\'':
+      entity = "&#39;";
+      break;
+    default:
+      continue;
+    }
+    out.write(value.data() + begin, idx - begin);
+    out << entity;
+    begin = idx + 1;
+  }
+  out.write(value.data() + begin, value.length() - begin);
+}
+
+// Templates are plain HTML with {{slot}} for an escaped value, {{&slot}}
+// for markup, {{%slot}} for entry text and {{#slot}}..{{/slot}} or
+// {{^slot}}..{{/slot}} around parts shown only when the slot is set or
+// empty. Compiling resolves the slot names and section ends up front, so
+// rendering is a single pass over the ops.
+bool templateCompile(string_view source, TEMPLATE &compiled) {
+  compiled.ops.clear();
+  compiled.text.clear();
+
+  vector<size_t> open;
+  size_t pos = 0;
+  while (pos < source.length()) {
+    size_t tag = source.find("{{", pos);
+    if (tag == string_view::npos)
+      tag = source.length();
+
+    if (tag > pos) {
+      TEMPLATE_OP op = {OP_TEXT, 0,
+                        static_cast<uint32_t>(compiled.text.length()),
+                        static_cast<uint32_t>(tag - pos)};
+      compiled.ops.push_back(op);
+      compiled.text.append(source.substr(pos, tag - pos));
+    }
+    if (tag == source.length())
+      break;
+
+    size_t end = source.find("}}", tag + 2);
+    if (end == string_view::npos)
+      return (false);
+    string_view name = source.substr(tag + 2, end - tag - 2);
+    pos = end + 2;
+
+    uint8_t code = OP_ESCAPE;
+    bool close = false;
+    if (!name.empty() && strchr("&%#^/", name[0]) != NULL) {
+      switch (name[0]) {
+      case '&':
+        code = OP_RAW;
+        break;
+      case '%':
+        code = OP_LINES;
+        break;
+      case '#':
+        code = OP_IF;
+        break;
+      case '^':
+        code = OP_UNLESS;
+        break;
+      default:
+        close = true;
+      }
+      name.remove_prefix(1);
+    }
+
+    int slot = slotIndex(name);
+    if (slot < 0)
+      return (false);
+
+    // a section jumps to the op following its end when skipped
+    if (close) {
+      if (open.empty() || compiled.ops[open.back()].slot != slot)
+        return (false);
+      compiled.ops[open.back()].length = compiled.ops.size();
+      open.pop_back();
+      continue;
+    }
+
+    if (code == OP_IF || code == OP_UNLESS)
+      open.push_back(compiled.ops.size());
+    TEMPLATE_OP op = {code, static_cast<uint8_t>(slot), 0, 0};
+    compiled.ops.push_back(op);
+  }
+
+  return (open.empty());
+}
+
+// Themes may replace any page with <directory><name>.html; the file is
+// checked once per request and compiled again only when it changed.
+void templateTheme(const string &directory) {
+  if (directory != themeDirectory) {
+    themeDirectory = directory;
+    for (int name = 0; name < TEMPLATES; name++) {
+      memset(&themed[name].f_stat, 0, sizeof(struct stat));
+      themed[name].valid = false;
+    }
+  }
+  generation++;
+}
+
+static const TEMPLATE &page(TEMPLATE_NAME name) {
+  if (!defaultsCompiled) {
+    for (int i = 0; i < TEMPLATES; i++)
+      templateCompile(pageSources[i], defaults[i]);
+    defaultsCompiled = true;
+  }
+
+  THEME_PAGE &theme = themed[name];
+  if (theme.checked == generation)
+    return (*theme.active);
+  theme.checked = generation;
+  theme.active = &defaults[name];
+
+  struct stat f_stat;
+  string path = themeDirectory + pageNames[name] + ".html";
+  if (themeDirectory.empty() || stat(path.c_str(), &f_stat) != 0)
+    return (*theme.active);
+
+  if (f_stat.st_ino != theme.f_stat.st_ino ||
+      f_stat.st_size != theme.f_stat.st_size ||
+      f_stat.st_mtime != theme.f_stat.st_mtime) {
+    ifstream ifstr(path.c_str(), ios::in | ios::binary);
+    ostringstream source;
+    source << ifstr.rdbuf();
+    theme.valid =
+        !ifstr.fail() && templateCompile(source.str(), theme.compiled);
+    theme.f_stat = f_stat;
+  }
+
+  // a theme page that does not compile falls back to the default
+  if (theme.valid)
+    theme.active = &theme.compiled;
+
+  return (*theme.active);
+}
+
+// What the pages of this request are rendered from: the defaults by their
+// source and the theme pages replacing them by their file. modified is
+// set to the newest of those files.
+string templateStamp(time_t &modified) {
+  static size_t sources = 0;
+  if (sources == 0) {
+    string all;
+    for (int name = 0; name < TEMPLATES; name++)
+      all += pageSources[name];
+    sources = hash<string>()(all);
+  }
+
+  string stamp = to_string(sources) + ' ' + themeDirectory;
+  modified = 0;
+  for (int name = 0; name < TEMPLATES; name++) {
+    if (&page(static_cast<TEMPLATE_NAME>(name)) != &themed[name].compiled)
+      continue;
+
+    const struct stat &f_stat = themed[name].f_stat;
+    stamp += ' ' + to_string(name) + ':' + to_string(f_stat.st_ino) + ':' +
+             to_string(f_stat.st_size) + ':' +
+             to_string(f_stat.st_mtim.tv_sec) + '.' +
+             to_string(f_stat.st_mtim.tv_nsec);
+    modified = max(modified, f_stat.st_mtime);
+  }
+
+  return (stamp);
+}
+
+void templateRender(ostream &out, TEMPLATE_NAME name,
+                    const TEMPLATE_VALUES &values) {
+  const TEMPLATE &compiled = page(name);
+  const TEMPLATE_OP *ops = compiled.ops.data();
+
+  size_t count = compiled.ops.size();
+  for (size_t idx = 0; idx < count;) {
+    const TEMPLATE_OP &op = ops[idx++];
+    string_view value = values[op.slot];
+    switch (op.code) {
+    case OP_TEXT:
+      out.write(compiled.text.data() + op.offset, op.length);
+      break;
+    case OP_ESCAPE:
+      escape(out, value);
+      break;
+    case OP_RAW:
+      out.write(value.data(), value.length());
+      break;
+    case OP_LINES:
+      toHTML(out, value);
+      break;
+    case OP_IF:
+      if (value.empty())
+        idx = op.length;
+      break;
+    case OP_UNLESS:
+      if (!value.empty())
+        idx = op.length;
+    }
+  }
+}
+
+// only line breaks and double spaces change, so the text in between is
+// skipped with the vector scanner and copied in one piece
+void toHTML(ostream &out, string_view noneHTML) {
+  SEARCH_SET special;
+  searchSet("\n\r", ' ', special);
+
+  size_t begin = 0, length = noneHTML.length(), idx = 0;
+  while ((idx = searchAny(special, noneHTML, idx)) != string_view::npos) {
+    const char *replace = NULL;
+    if (noneHTML[idx] == '\n' ||
+        (noneHTML[idx] == '\r' && idx + 1 < length &&
+         noneHTML[idx + 1] == '\n'))
+      replace = "<br />\n";
+    else if (noneHTML[idx] == ' ')
+      replace = " &nbsp;";
+
+    if (replace == NULL) {
+      idx++;
+      continue;
+    }
+    out.write(noneHTML.data() + begin, idx - begin);
+    out << replace;
+    // a CRLF pair or a double space is replaced as a whole
+    if (noneHTML[idx] != '\n')
+      idx++;
+    begin = ++idx;
+  }
+  out.write(noneHTML.data() + begin, length - begin);
+}
+
+// Text between tags is searched with the vector kernel and copied in
+// runs; tags are copied as they are so a match never lands inside one.
+string highlight(string_view content, const string &match) {
+  const string open = "<span class=\"highlight\" title=\"highlighted\">",
+               close = "</span>";
+
+  string highlighted;
+  highlighted.reserve(content.length() + content.length() / 8);
+
+  SEARCH_PATTERN pattern;
+  searchCompile(match, pattern);
+
+  size_t pos = 0, length = content.length();
+  while (pos < length) {
+    size_t tag = content.find('<', pos);
+    if (tag == string_view::npos)
+      tag = length;
+
+    string_view text = content.substr(0, tag);
+    size_t at;
+    while (!match.empty() &&
+           (at = searchFind(pattern, text, pos)) != string_view::npos) {
+      highlighted.append(content.data() + pos, at - pos);
+      highlighted += open;
+      highlighted.append(content.data() + at, match.length());
+      highlighted += close;
+      pos = at + match.length();
+    }
+    highlighted.append(content.data() + pos, tag - pos);
+    if (tag == length)
+      break;
+
+    // an unclosed tag runs to the end of the content
+    pos = content.find('>', tag);
+    pos = pos == string_view::npos ? length : pos + 1;
+    highlighted.append(content.data() + tag, pos - tag);
+  }
+
+  return (highlighted);
+}
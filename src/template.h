@@ -0,0 +1,107 @@
+/**
+ *  @file   template.h
+ *  @brief  Precompiled page templates
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef TEMPLATE_H_
+#define TEMPLATE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+typedef enum {
+  PAGE_HEADER,
+  PAGE_MENU,
+  PAGE_FOOTER,
+  PAGE_ERROR,
+  PAGE_SETUP,
+  PAGE_ENTRY,
+  PAGE_EDIT,
+  PAGE_RESULTS,
+  PAGE_RESULT,
+  PAGE_RESULTS_FOOTER,
+  PAGE_PAGES,
+  PAGE_STATS,
+  TEMPLATES
+} TEMPLATE_NAME;
+
+typedef enum {
+  SLOT_SELF,
+  SLOT_BASE,
+  SLOT_PLUGIN,
+  SLOT_SCHEME,
+  SLOT_ADMINISTRATOR,
+  SLOT_PAGE_SIZE,
+  SLOT_MATCH,
+  SLOT_YEAR,
+  SLOT_ID,
+  SLOT_DATE,
+  SLOT_CONTENT,
+  SLOT_NAVIGATION,
+  SLOT_PREVIOUS,
+  SLOT_PREVIOUS_DATE,
+  SLOT_NEXT,
+  SLOT_NEXT_DATE,
+  SLOT_LIMIT,
+  SLOT_NEWER,
+  SLOT_CURSOR,
+  SLOT_AT,
+  SLOT_MATCHED,
+  SLOT_QUERY,
+  SLOT_CODE,
+  SLOT_MESSAGE,
+  SLOT_LOG,
+  SLOT_LOG_STATUS,
+  SLOT_PLUGIN_STATUS,
+  SLOT_THEMES,
+  SLOT_STATS,
+  TEMPLATE_SLOTS
+} TEMPLATE_SLOT;
+
+typedef string_view TEMPLATE_VALUES[TEMPLATE_SLOTS];
+
+typedef enum {
+  OP_TEXT,
+  OP_ESCAPE,
+  OP_RAW,
+  OP_LINES,
+  OP_IF,
+  OP_UNLESS
+} TEMPLATE_OPCODE;
+
+typedef struct {
+  uint8_t code;
+  uint8_t slot;
+  uint32_t offset;
+  uint32_t length;
+} TEMPLATE_OP;
+
+typedef struct {
+  vector<TEMPLATE_OP> ops;
+  string text;
+} TEMPLATE;
+
+extern const char *const pageNames[TEMPLATES];
+extern const char *const pageSources[TEMPLATES];
+
+bool templateCompile(string_view source, TEMPLATE &compiled);
+void templateTheme(const string &directory);
+string templateStamp(time_t &modified);
+void templateRender(ostream &out, TEMPLATE_NAME name,
+                    const TEMPLATE_VALUES &values);
+
+void toHTML(ostream &out, string_view noneHTML);
+string highlight(string_view content, const string &match);
+
+#endif // TEMPLATE_H_
@@ -0,0 +1,589 @@
+/**
+ *  @file   words.cpp
+ *  @brief  Ranked full-text word index for the log file
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#include "words.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+#include "days.h"
+
+static const char wordsMagic[8] = {'B', 'o', 'L', 'w', 'r', 'd', '3', '\0'};
+
+// terms longer than this are cut short
+const size_t maxTerm = 64;
+
+// BM25 parameters
+const double k1 = 1.2, b = 0.75;
+
+typedef struct {
+  uint32_t count;
+  string data;
+} WORDS_LIST;
+
+typedef struct {
+  uint32_t key;
+  vector<uint32_t> positions;
+} WORDS_POSTING;
+
+typedef map<string, vector<uint32_t>> WORDS_TERMS;
+
+static void putVarint(string &out, uint32_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out += static_cast<char>(value);
+}
+
+static bool getVarint(const char *&at, const char *end, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; at < end && shift < 35; shift += 7) {
+    unsigned char c = *at++;
+    value |= static_cast<uint32_t>(c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return (true);
+  }
+  return (false);
+}
+
+static bool wordChar(unsigned char c) {
+  return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c >= 0x80);
+}
+
+// finds the next word in text from at on, skipping HTML tags, puts it
+// lower-cased in term and returns where it starts, or npos past the last
+static size_t nextWord(string_view text, size_t &at, string &term) {
+  size_t start = 0;
+  bool tag = false;
+  term.clear();
+  for (; at <= text.length(); at++) {
+    unsigned char c = at < text.length() ? text[at] : ' ';
+    if (tag) {
+      tag = c != '>';
+      continue;
+    }
+
+    if (wordChar(c)) {
+      if (term.empty())
+        start = at;
+      if (term.length() < maxTerm)
+        term += c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+      continue;
+    }
+
+    if (!term.empty())
+      return (start);
+
+    if (c == '<' && at + 1 < text.length() &&
+        (isalpha(static_cast<unsigned char>(text[at + 1])) ||
+         text[at + 1] == '/' || text[at + 1] == '!'))
+      tag = true;
+  }
+
+  return (string_view::npos);
+}
+
+// splits text into lower-cased words, skipping HTML tags, and returns the
+// number of words
+static uint32_t tokenize(string_view text, WORDS_TERMS &terms) {
+  uint32_t position = 0;
+  string term;
+  for (size_t at = 0; nextWord(text, at, term) != string_view::npos;)
+    terms[term].push_back(position++);
+
+  return (position);
+}
+
+static void encodeList(const vector<WORDS_POSTING> &postings,
+                       WORDS_LIST &list) {
+  list.count = postings.size();
+  list.data.clear();
+
+  uint32_t previous = 0;
+  for (size_t i = 0; i < postings.size(); i++) {
+    putVarint(list.data, postings[i].key - previous);
+    previous = postings[i].key;
+
+    putVarint(list.data, postings[i].positions.size());
+    uint32_t last = 0;
+    for (size_t j = 0; j < postings[i].positions.size(); j++) {
+      putVarint(list.data, postings[i].positions[j] - last);
+      last = postings[i].positions[j];
+    }
+  }
+}
+
+static bool decodeList(const WORDS_LIST &list,
+                       vector<WORDS_POSTING> &postings) {
+  const char *at = list.data.data(), *end = at + list.data.length();
+
+  uint32_t key = 0;
+  for (uint32_t i = 0; i < list.count; i++) {
+    uint32_t delta, tf;
+    if (!getVarint(at, end, delta) || !getVarint(at, end, tf))
+      return (false);
+
+    WORDS_POSTING posting;
+    posting.key = key += delta;
+
+    uint32_t position = 0;
+    for (uint32_t j = 0; j < tf; j++) {
+      if (!getVarint(at, end, delta))
+        return (false);
+      posting.positions.push_back(position += delta);
+    }
+    postings.push_back(posting);
+  }
+
+  return (true);
+}
+
+static size_t layoutLength(const WORDS_HEADER *header) {
+  return (sizeof(WORDS_HEADER) + header->docs * sizeof(WORDS_DOC) +
+          header->terms * sizeof(WORDS_TERM) + header->blob);
+}
+
+static void layout(WORDS_INDEX &index, const char *data) {
+  index.header = reinterpret_cast<const WORDS_HEADER *>(data);
+  data += sizeof(WORDS_HEADER);
+  index.docs = reinterpret_cast<const WORDS_DOC *>(data);
+  data += index.header->docs * sizeof(WORDS_DOC);
+  index.terms = reinterpret_cast<const WORDS_TERM *>(data);
+  data += index.header->terms * sizeof(WORDS_TERM);
+  index.blob = data;
+}
+
+static ERROR_CODE mapWords(WORDS_INDEX &index) {
+  int fd = open(index.path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return (IO_READ);
+
+  struct stat w_stat;
+  if (fstat(fd, &w_stat) != 0 ||
+      static_cast<size_t>(w_stat.st_size) < sizeof(WORDS_HEADER)) {
+    close(fd);
+    return (STRUCTURE);
+  }
+
+  void *map = mmap(NULL, w_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return (IO_READ);
+
+  const WORDS_HEADER *header = static_cast<const WORDS_HEADER *>(map);
+  if (memcmp(header->magic, wordsMagic, 8) != 0 ||
+      layoutLength(header) != static_cast<size_t>(w_stat.st_size)) {
+    munmap(map, w_stat.st_size);
+    return (STRUCTURE);
+  }
+
+  index.map = map;
+  index.mapLength = w_stat.st_size;
+  layout(index, static_cast<const char *>(map));
+
+  return (OK);
+}
+
+static void stamp(WORDS_HEADER &header, const struct stat &f_stat) {
+  header.size = f_stat.st_size;
+  header.mtime = f_stat.st_mtime;
+  header.inode = f_stat.st_ino;
+}
+
+// adds length bytes at data to the pieces, as part of the last one if it
+// ends right there
+static void addPiece(vector<string_view> &pieces, const char *data,
+                     size_t length) {
+  if (!pieces.empty() && pieces.back().data() + pieces.back().length() == data)
+    pieces.back() = string_view(pieces.back().data(),
+                                pieces.back().length() + length);
+  else
+    pieces.push_back(string_view(data, length));
+}
+
+// Writes the index out of pieces, which may point into its current mapping,
+// and maps the new file in its place.
+static ERROR_CODE writeWords(WORDS_INDEX &index,
+                             const vector<string_view> &pieces) {
+  string tmp = index.path + ".tmp." + to_string(getpid());
+  ofstream ofstr(tmp.c_str(), ios::out | ios::binary);
+  for (size_t i = 0; !ofstr.fail() && i < pieces.size(); i++)
+    ofstr.write(pieces[i].data(), pieces[i].length());
+  ofstr.close();
+
+  WORDS_INDEX written = {};
+  written.path = index.path;
+  if (!ofstr.fail() && rename(tmp.c_str(), index.path.c_str()) == 0 &&
+      mapWords(written) == OK) {
+    wordsClose(index);
+    index = written;
+    return (OK);
+  }
+  unlink(tmp.c_str());
+
+  // the sidecar could not be written; keep ranking from memory
+  string data;
+  for (size_t i = 0; i < pieces.size(); i++)
+    data += pieces[i];
+  wordsClose(index);
+  index.map = new char[data.length()];
+  index.mapLength = 0;
+  memcpy(index.map, data.data(), data.length());
+  layout(index, static_cast<const char *>(index.map));
+
+  return (OK);
+}
+
+static ERROR_CODE writeLists(WORDS_INDEX &index, const struct stat &f_stat,
+                             const map<uint32_t, uint32_t> &docs,
+                             const map<string, WORDS_LIST> &lists) {
+  WORDS_HEADER header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, wordsMagic, 8);
+  stamp(header, f_stat);
+  header.docs = docs.size();
+  header.terms = lists.size();
+
+  string table, blob;
+  for (map<uint32_t, uint32_t>::const_iterator it = docs.begin();
+       it != docs.end(); it++) {
+    WORDS_DOC doc = {it->first, it->second};
+    table.append(reinterpret_cast<const char *>(&doc), sizeof(doc));
+    header.total += it->second;
+  }
+
+  for (map<string, WORDS_LIST>::const_iterator it = lists.begin();
+       it != lists.end(); it++) {
+    WORDS_TERM term;
+    term.offset = blob.length();
+    term.length = it->first.length();
+    term.count = it->second.count;
+    blob += it->first;
+    term.list = blob.length();
+    term.listLength = it->second.data.length();
+    blob += it->second.data;
+    table.append(reinterpret_cast<const char *>(&term), sizeof(term));
+  }
+  header.blob = blob.length();
+
+  vector<string_view> pieces;
+  pieces.push_back(
+      string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+  pieces.push_back(table);
+  pieces.push_back(blob);
+
+  return (writeWords(index, pieces));
+}
+
+static const WORDS_TERM *findTerm(const WORDS_INDEX &index,
+                                  const string &term) {
+  long low = 0, high = index.header->terms;
+  while (low < high) {
+    long mid = (low + high) / 2;
+    const WORDS_TERM &at = index.terms[mid];
+    if (string_view(index.blob + at.offset, at.length) < term)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low < static_cast<long>(index.header->terms) &&
+      string_view(index.blob + index.terms[low].offset,
+                  index.terms[low].length) == term)
+    return (&index.terms[low]);
+
+  return (NULL);
+}
+
+static uint32_t docLength(const WORDS_INDEX &index, uint32_t key) {
+  long low = 0, high = index.header->docs;
+  while (low < high) {
+    long mid = (low + high) / 2;
+    if (index.docs[mid].key < key)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low < static_cast<long>(index.header->docs) &&
+      index.docs[low].key == key)
+    return (index.docs[low].length);
+
+  return (0);
+}
+
+ERROR_CODE wordsLoad(const string &log, WORDS_INDEX &index) {
+  wordsClose(index);
+  index.path = log + ".words";
+
+  return (mapWords(index));
+}
+
+bool wordsCurrent(const WORDS_INDEX &index, const struct stat &f_stat) {
+  return (index.map != NULL &&
+          index.header->size == static_cast<uint64_t>(f_stat.st_size) &&
+          index.header->mtime == static_cast<int64_t>(f_stat.st_mtime) &&
+          index.header->inode == static_cast<uint64_t>(f_stat.st_ino));
+}
+
+ERROR_CODE wordsBuild(WORDS_INDEX &index, const string &log,
+                      const struct stat &f_stat,
+                      const vector<WORDS_ENTRY> &entries) {
+  map<uint32_t, uint32_t> docs;
+  map<string, vector<WORDS_POSTING>> postings;
+  map<uint32_t, WORDS_TERMS> terms;
+
+  // postings are delta coded, so add the entries in key order; entries
+  // without words are no documents
+  for (size_t i = 0; i < entries.size(); i++) {
+    uint32_t key = dayKey(entries[i].first);
+    if (key == 0)
+      continue;
+    uint32_t length = tokenize(entries[i].second, terms[key]);
+    if (length > 0)
+      docs[key] = length;
+    else
+      docs.erase(key);
+  }
+
+  for (map<uint32_t, WORDS_TERMS>::iterator doc = terms.begin();
+       doc != terms.end(); doc++)
+    for (WORDS_TERMS::iterator it = doc->second.begin();
+         it != doc->second.end(); it++) {
+      WORDS_POSTING posting = {doc->first, it->second};
+      postings[it->first].push_back(posting);
+    }
+
+  map<string, WORDS_LIST> lists;
+  for (map<string, vector<WORDS_POSTING>>::iterator it = postings.begin();
+       it != postings.end(); it++)
+    encodeList(it->second, lists[it->first]);
+
+  wordsClose(index);
+  index.path = log + ".words";
+
+  return (writeLists(index, f_stat, docs, lists));
+}
+
+ERROR_CODE wordsUpdate(WORDS_INDEX &index, const struct stat &f_stat,
+                       const string &ID, string_view previous,
+                       string_view content) {
+  uint32_t key = dayKey(ID);
+  if (index.map == NULL || key == 0)
+    return (STRUCTURE);
+
+  // only the posting lists of words that were or are in the entry change
+  WORDS_TERMS before, after;
+  tokenize(previous, before);
+  uint32_t length = tokenize(content, after);
+
+  WORDS_TERMS touched(before);
+  touched.insert(after.begin(), after.end());
+
+  map<string, WORDS_LIST> lists;
+  for (WORDS_TERMS::iterator it = touched.begin(); it != touched.end(); it++) {
+    vector<WORDS_POSTING> postings;
+    const WORDS_TERM *term = findTerm(index, it->first);
+    WORDS_LIST list = {0, ""};
+    if (term != NULL) {
+      list.count = term->count;
+      list.data.assign(index.blob + term->list, term->listLength);
+    }
+    if (!decodeList(list, postings))
+      return (STRUCTURE);
+
+    size_t at = 0;
+    while (at < postings.size() && postings[at].key < key)
+      at++;
+    if (at < postings.size() && postings[at].key == key)
+      postings.erase(postings.begin() + at);
+
+    WORDS_TERMS::iterator added = after.find(it->first);
+    if (added != after.end()) {
+      WORDS_POSTING posting = {key, added->second};
+      postings.insert(postings.begin() + at, posting);
+    }
+
+    encodeList(postings, lists[it->first]);
+  }
+
+  // the documents are in key order, the entry's is replaced, inserted or,
+  // when it has no words left, removed
+  WORDS_HEADER header = *index.header;
+  stamp(header, f_stat);
+  long at = 0, count = header.docs;
+  while (at < count && index.docs[at].key < key)
+    at++;
+  bool known = at < count && index.docs[at].key == key, kept = length > 0;
+  header.total = header.total + length - (known ? index.docs[at].length : 0);
+  header.docs = header.docs + kept - known;
+  WORDS_DOC doc = {key, length};
+
+  // The table of terms is written anew, the blob is copied over in runs
+  // of unchanged terms and their lists, each of which lies right after the
+  // one before it, with the changed lists in between.
+  vector<string_view> blob;
+  string table;
+  uint64_t offset = 0;
+  map<string, WORDS_LIST>::iterator changed = lists.begin();
+  for (uint32_t i = 0; i < index.header->terms || changed != lists.end();) {
+    int order = i >= index.header->terms ? 1
+                : changed == lists.end()
+                    ? -1
+                    : string_view(index.blob + index.terms[i].offset,
+                                  index.terms[i].length)
+                          .compare(changed->first);
+    if (order < 0) {
+      WORDS_TERM term = index.terms[i++];
+      uint64_t size = term.list + term.listLength - term.offset;
+      addPiece(blob, index.blob + term.offset, size);
+      term.list = offset + term.list - term.offset;
+      term.offset = offset;
+      offset += size;
+      table.append(reinterpret_cast<const char *>(&term), sizeof(term));
+      continue;
+    }
+
+    if (order == 0)
+      i++;
+    const WORDS_LIST &list = changed->second;
+    if (list.count > 0) {
+      WORDS_TERM term = {offset, static_cast<uint32_t>(changed->first.length()),
+                         list.count, offset + changed->first.length(),
+                         list.data.length()};
+      addPiece(blob, changed->first.data(), changed->first.length());
+      addPiece(blob, list.data.data(), list.data.length());
+      offset += term.length + term.listLength;
+      table.append(reinterpret_cast<const char *>(&term), sizeof(term));
+    }
+    changed++;
+  }
+  header.terms = table.length() / sizeof(WORDS_TERM);
+  header.blob = offset;
+
+  vector<string_view> pieces;
+  pieces.push_back(
+      string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+  addPiece(pieces, reinterpret_cast<const char *>(index.docs),
+           at * sizeof(WORDS_DOC));
+  if (kept)
+    pieces.push_back(
+        string_view(reinterpret_cast<const char *>(&doc), sizeof(doc)));
+  addPiece(pieces, reinterpret_cast<const char *>(index.docs + at + known),
+           (count - at - known) * sizeof(WORDS_DOC));
+  pieces.push_back(table);
+  pieces.insert(pieces.end(), blob.begin(), blob.end());
+
+  return (writeWords(index, pieces));
+}
+
+void wordsClose(WORDS_INDEX &index) {
+  if (index.map != NULL) {
+    if (index.mapLength)
+      munmap(index.map, index.mapLength);
+    else
+      delete[] static_cast<char *>(index.map);
+  }
+  index.map = NULL;
+  index.mapLength = 0;
+  index.header = NULL;
+  index.docs = NULL;
+  index.terms = NULL;
+  index.blob = NULL;
+}
+
+void wordsTerms(string_view text, vector<string> &terms) {
+  WORDS_TERMS found;
+  tokenize(text, found);
+  for (WORDS_TERMS::iterator it = found.begin(); it != found.end(); it++)
+    terms.push_back(it->first);
+}
+
+// Returns where the first word of text that is one of terms starts, or the
+// length of text if none is.
+size_t wordsFind(string_view text, const vector<string> &terms) {
+  string term;
+  size_t at = 0, start;
+  while ((start = nextWord(text, at, term)) != string_view::npos)
+    if (find(terms.begin(), terms.end(), term) != terms.end())
+      return (start);
+
+  return (text.length());
+}
+
+void wordsRank(const WORDS_INDEX &index, const string &query, size_t limit,
+               vector<WORDS_HIT> &hits) {
+  hits.clear();
+  if (index.map == NULL || limit == 0 || index.header->docs == 0)
+    return;
+
+  WORDS_TERMS terms;
+  tokenize(query, terms);
+
+  double N = index.header->docs,
+         average = static_cast<double>(index.header->total) / N;
+  if (average == 0)
+    average = 1;
+
+  unordered_map<uint32_t, double> scores;
+  for (WORDS_TERMS::iterator it = terms.begin(); it != terms.end(); it++) {
+    const WORDS_TERM *term = findTerm(index, it->first);
+    if (term == NULL)
+      continue;
+
+    double df = term->count, idf = log(1 + (N - df + 0.5) / (df + 0.5));
+
+    const char *at = index.blob + term->list, *end = at + term->listLength;
+    uint32_t key = 0;
+    for (uint32_t i = 0; i < term->count; i++) {
+      uint32_t delta, tf, position;
+      if (!getVarint(at, end, delta) || !getVarint(at, end, tf))
+        break;
+      key += delta;
+      for (uint32_t j = 0; j < tf; j++)
+        getVarint(at, end, position);
+
+      double length = docLength(index, key) / average;
+      scores[key] += idf * tf * (k1 + 1) / (tf + k1 * (1 - b + b * length));
+    }
+  }
+
+  // keep the best hits in a bounded heap with the weakest on top; equal
+  // scores favour the more recent entry
+  typedef pair<double, uint32_t> SCORED;
+  auto better = [](const SCORED &x, const SCORED &y) {
+    return (x.first > y.first || (x.first == y.first && x.second > y.second));
+  };
+  priority_queue<SCORED, vector<SCORED>, decltype(better)> heap(better);
+  for (unordered_map<uint32_t, double>::iterator it = scores.begin();
+       it != scores.end(); it++) {
+    heap.push(SCORED(it->second, it->first));
+    if (heap.size() > limit)
+      heap.pop();
+  }
+
+  hits.resize(heap.size());
+  for (size_t i = hits.size(); i-- > 0; heap.pop()) {
+    hits[i].ID = dayID(heap.top().second);
+    hits[i].score = heap.top().first;
+  }
+}
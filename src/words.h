@@ -0,0 +1,81 @@
+/**
+ *  @file   words.h
+ *  @brief  Ranked full-text word index for the log file
+ *  @author KrizTioaN (christiaanboersma@hotmail.com)
+ *  @date   2026-10-18
+ *  @note   BSD-3 licensed
+ *
+ ***********************************************/
+
+#ifndef WORDS_H_
+#define WORDS_H_
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logger.h"
+
+using namespace std;
+
+typedef struct {
+  char magic[8];
+  uint64_t size;
+  int64_t mtime;
+  uint64_t inode;
+  uint32_t docs;
+  uint32_t terms;
+  uint64_t total;
+  uint64_t blob;
+} WORDS_HEADER;
+
+typedef struct {
+  uint32_t key;
+  uint32_t length;
+} WORDS_DOC;
+
+typedef struct {
+  uint64_t offset;
+  uint32_t length;
+  uint32_t count;
+  uint64_t list;
+  uint64_t listLength;
+} WORDS_TERM;
+
+typedef struct {
+  string path;
+  void *map;
+  size_t mapLength;
+  const WORDS_HEADER *header;
+  const WORDS_DOC *docs;
+  const WORDS_TERM *terms;
+  const char *blob;
+} WORDS_INDEX;
+
+typedef struct {
+  string ID;
+  double score;
+} WORDS_HIT;
+
+typedef pair<string, string_view> WORDS_ENTRY;
+
+ERROR_CODE wordsLoad(const string &log, WORDS_INDEX &index);
+bool wordsCurrent(const WORDS_INDEX &index, const struct stat &f_stat);
+ERROR_CODE wordsBuild(WORDS_INDEX &index, const string &log,
+                      const struct stat &f_stat,
+                      const vector<WORDS_ENTRY> &entries);
+ERROR_CODE wordsUpdate(WORDS_INDEX &index, const struct stat &f_stat,
+                       const string &ID, string_view previous,
+                       string_view content);
+void wordsClose(WORDS_INDEX &index);
+
+void wordsTerms(string_view text, vector<string> &terms);
+size_t wordsFind(string_view text, const vector<string> &terms);
+void wordsRank(const WORDS_INDEX &index, const string &query, size_t limit,
+               vector<WORDS_HIT> &hits);
+
+#endif // WORDS_H_